@@ -0,0 +1,223 @@
+#include "Batch.h"
+#include "InstanceParser.h"
+#include "WorkerPool.h"
+#include <fstream>
+#include <sstream>
+#include <functional>
+
+namespace tabu {
+
+Batch::Batch(const BatchJob &defaults, unsigned int n_threads) :
+		defaults(defaults) {
+
+	if(n_threads == 0)
+		n_threads = std::thread::hardware_concurrency();
+	if(n_threads == 0)
+		n_threads = 1;
+
+	this->n_threads = n_threads;
+	this->job_threads = 1;
+	this->cl_program = NULL;
+	this->next_job = 0;
+	this->out = NULL;
+}
+
+Batch::~Batch() {
+	for(unsigned int w=0;w<sessions.size();w++){
+		std::map<std::string, Session *>::iterator s;
+		for(s=sessions[w].begin();s!=sessions[w].end();++s)
+			delete s->second;
+	}
+	std::map<std::string, Matrix *>::iterator it;
+	for(it=instances.begin();it!=instances.end();++it)
+		delete it->second;
+	delete cl_program;
+}
+
+bool Batch::parse_line(const std::string &line, int line_number, BatchJob &job) {
+
+	std::istringstream tokens(line.substr(0, line.find('#')));
+	std::string token;
+	if(!(tokens >> job.instance))
+		return false; // línea vacía
+
+	while(tokens >> token){
+		std::string value;
+		if(token == "-P"){
+			job.backend = "opencl";
+			continue;
+		}
+		if(token.size() != 2 || token[0] != '-' || !(tokens >> value)){
+			std::ostringstream msg;
+			msg << "línea " << line_number << ": opción inválida '" << token << "'";
+			error = msg.str();
+			job.instance.clear();
+			return false;
+		}
+
+		const char *arg = value.c_str();
+		switch(token[1]){
+		case 'i': job.iterations = strtoul(arg, NULL, 10); break;
+		case 'd': job.diversification_param = atoi(arg); break;
+		case 'c': job.cells = strtoul(arg, NULL, 10); break;
+		case 'm': job.max_machines_cell = strtoul(arg, NULL, 10); break;
+		case 't': job.tabu_turns = atoi(arg); break;
+		case 'S': job.seed = strtoul(arg, NULL, 10); break;
+		case 'L': job.candidate_list_period = strtoul(arg, NULL, 10); break;
+		case 'B': job.time_budget = atof(arg); break;
+		case 'N': job.stagnation_limit = strtoul(arg, NULL, 10); break;
+		case 'G': job.target_cost = atoi(arg); break;
+		case 'W': job.diversification_candidates = strtoul(arg, NULL, 10); break;
+		case 'E': job.elite_size = strtoul(arg, NULL, 10); break;
+		case 'X': job.relink_period = strtoul(arg, NULL, 10); break;
+		case 'T': job.backend = "threaded"; job.threads = strtoul(arg, NULL, 10); break;
+		default:
+			std::ostringstream msg;
+			msg << "línea " << line_number << ": opción desconocida '" << token << "'";
+			error = msg.str();
+			job.instance.clear();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::string Batch::bound_key(const BatchJob &job) {
+	std::ostringstream key;
+	key << job.instance << "/" << job.cells << "/" << job.max_machines_cell;
+	return key.str();
+}
+
+bool Batch::load(const char *manifest) {
+
+	std::ifstream file(manifest);
+	if(!file.is_open()){
+		error = std::string(manifest) + ": no se pudo abrir el manifiesto";
+		return false;
+	}
+
+	std::string line;
+	int line_number = 0;
+	while(std::getline(file, line)){
+		line_number++;
+		BatchJob job = defaults;
+		if(parse_line(line, line_number, job)){
+			jobs.push_back(job);
+			continue;
+		}
+		if(!error.empty()){
+			error = std::string(manifest) + ": " + error;
+			return false;
+		}
+	}
+
+	// cada instancia se lee una vez, con sus índices listos antes de que
+	// los hilos la compartan
+	for(unsigned int j=0;j<jobs.size();j++){
+		if(instances.count(jobs[j].instance))
+			continue;
+		InstanceParser parser;
+		Matrix *mat = parser.parse_input(jobs[j].instance.c_str());
+		if(mat == NULL){
+			error = parser.error;
+			return false;
+		}
+		mat->row_index();
+		mat->col_index();
+		instances[jobs[j].instance] = mat;
+	}
+
+	// la cota inferior sólo depende de la instancia, las celdas y el
+	// máximo por celda: una vez por combinación, antes de los hilos
+	for(unsigned int j=0;j<jobs.size();j++){
+		std::string key = bound_key(jobs[j]);
+		if(bounds.count(key))
+			continue;
+		Matrix *mat = instances[jobs[j].instance];
+		bounds[key] = exceptional_lower_bound(mat->col_index(), mat->rows,
+				mat->cols, jobs[j].cells, jobs[j].max_machines_cell);
+	}
+
+	return true;
+}
+
+void Batch::run(FILE *out) {
+
+	this->out = out;
+	this->next_job = 0;
+
+	for(unsigned int j=0;j<jobs.size();j++){
+		if(jobs[j].backend == "opencl" && cl_program == NULL){
+			cl_program = new ClProgram();
+			cl_program->cache_dir = cl_cache_dir;
+			cl_program->build();
+		}
+	}
+
+	fprintf(out, "#job\tinstance\tbackend\tseed\tcost\treal_cost\tfeasible\titerations\tseconds\tstop\n");
+
+	unsigned int threads = n_threads < jobs.size() ? n_threads : jobs.size();
+	sessions.resize(threads);
+
+	// los trabajos threaded simultáneos se reparten los núcleos, así el
+	// batch no lanza threads*núcleos hilos
+	unsigned int cores = std::thread::hardware_concurrency();
+	job_threads = threads > 0 && cores > threads ? cores/threads : 1;
+
+	WorkerPool pool(threads);
+	pool.run(std::bind(&Batch::run_worker, this, std::placeholders::_1));
+}
+
+void Batch::run_worker(unsigned int worker) {
+
+	while(true){
+		unsigned int j;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if(next_job == jobs.size())
+				return;
+			j = next_job++;
+		}
+		run_job(j, worker);
+	}
+}
+
+void Batch::run_job(unsigned int index, unsigned int worker) {
+
+	const BatchJob &job = jobs[index];
+	Matrix *mat = instances[job.instance];
+
+	// sesión del hilo para el backend (y número de hilos) del trabajo
+	unsigned int threads = job.threads;
+	if(threads == 0 || threads > job_threads)
+		threads = job_threads;
+	std::ostringstream key;
+	key << job.backend << "/" << threads;
+	Session *&session = sessions[worker][key.str()];
+	if(session == NULL)
+		session = new Session(job.backend, threads, cl_program);
+
+	SolveParams params = { job.iterations, job.diversification_param,
+			job.cells, job.max_machines_cell, job.tabu_turns, job.seed,
+			job.candidate_list_period, job.time_budget, job.stagnation_limit,
+			job.target_cost, job.diversification_candidates, job.elite_size,
+			job.relink_period, bounds.find(bound_key(job))->second };
+
+	Solution *sol = session->solve(mat, params);
+	Solver *solver = session->last_run();
+	int real_cost = solver->get_costo_real(sol);
+	bool feasible = solver->es_factible(sol);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		fprintf(out, "%u\t%s\t%s\t%u\t%d\t%d\t%s\t%u\t%.6f\t%s\n", index,
+				job.instance.c_str(), job.backend.c_str(), job.seed,
+				solver->global_best_cost, real_cost, feasible ? "SI" : "NO",
+				solver->n_iterations, solver->elapsed_time,
+				stop_reason_name(solver->stop_reason));
+		fflush(out);
+	}
+}
+
+} /* namespace tabu */
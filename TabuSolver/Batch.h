@@ -0,0 +1,76 @@
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include "Matrix.h"
+#include "Solver.h"
+#include "ParallelSolver.h"
+#include "Session.h"
+
+namespace tabu {
+
+typedef struct batch_job {
+
+	std::string instance;
+	std::string backend; // serial, threaded, opencl
+	unsigned int iterations;
+	int diversification_param;
+	unsigned int cells;
+	unsigned int max_machines_cell;
+	int tabu_turns;
+	unsigned int seed;
+	unsigned int threads;             // backend threaded
+	unsigned int candidate_list_period;
+	double time_budget;
+	unsigned int stagnation_limit;
+	int target_cost;
+	unsigned int diversification_candidates;
+	unsigned int elite_size;
+	unsigned int relink_period;
+} BatchJob;
+
+/*
+ * Modo batch (-b): un manifiesto con un trabajo por línea,
+ *   <instancia> [-i n] [-d n] [-c n] [-m n] [-t n] [-S semilla] [-L n]
+ *               [-W n] [-E n] [-X n] [-B segundos] [-N n] [-G costo] [-P | -T hilos]
+ * ('#' inicia un comentario). Lo que una línea no fija se toma del trabajo
+ * por omisión (las opciones de la línea de comandos). Cada instancia se lee
+ * una vez, los trabajos se reparten en n_threads hilos del proceso y los
+ * de OpenCL comparten un único contexto y programa compilado. Cada hilo
+ * resuelve con una Session por backend, que reutiliza entre trabajos. Los
+ * núcleos se reparten entre los trabajos simultáneos: un trabajo threaded
+ * usa a lo más núcleos/hilos del batch (-T 0 en la línea, todos esos). Se
+ * escribe una fila por trabajo, en el orden en que terminan.
+ */
+class Batch {
+public:
+	Batch(const BatchJob &defaults, unsigned int n_threads);
+	virtual ~Batch();
+	bool load(const char *manifest);
+	void run(FILE *out);
+	std::string error;
+	std::string cl_cache_dir; // caché de binarios del programa OpenCL
+private:
+	bool parse_line(const std::string &line, int line_number, BatchJob &job);
+	void run_worker(unsigned int worker);
+	void run_job(unsigned int index, unsigned int worker);
+	static std::string bound_key(const BatchJob &job);
+	BatchJob defaults;
+	std::vector<BatchJob> jobs;
+	std::map<std::string, Matrix *> instances;
+	std::map<std::string, long> bounds; // cota por instancia/celdas/máximo
+	ClProgram *cl_program;
+	std::vector<std::map<std::string, Session *> > sessions; // por hilo
+	unsigned int n_threads;
+	unsigned int job_threads; // hilos por trabajo threaded
+	unsigned int next_job;
+	FILE *out;
+	std::mutex mutex;
+};
+
+} /* namespace tabu */
+#endif /* BATCH_H_ */
@@ -0,0 +1,214 @@
+#include "BatchEvaluator.h"
+#include <cstring>
+#include <algorithm>
+
+namespace tabu {
+
+typedef int32_t v4si __attribute__((vector_size(16)));
+typedef int32_t v8si __attribute__((vector_size(32)));
+typedef int32_t v16si __attribute__((vector_size(64)));
+
+// con más celdas la penalización se cuenta con un histograma escalar
+#define BATCH_SIMD_MAX_CELLS 32
+
+/*
+ * Kernel genérico sobre vectores V de VW lanes; se instancia dentro de
+ * funciones compiladas para cada ISA. Por lane:
+ *   exceptional  suma sobre las partes de m_j - (máquinas en la primera
+ *                celda de la parte), como Solver::exceptional_elements
+ *   excess       suma sobre las celdas de max(0, máquinas - máximo)
+ */
+template<typename V, unsigned int VW>
+static inline __attribute__((always_inline)) void batch_kernel(
+		const int32_t *cells, const Adjacency &machines_of,
+		unsigned int n_machines, unsigned int n_parts, unsigned int n_cells,
+		unsigned int max_machines_cell, int32_t *exceptional, int32_t *excess) {
+
+	const unsigned int W = BatchEvaluator::LANES;
+	const unsigned int B = W / VW;
+	const V zero = {0};
+	const V none = zero + (int32_t)n_cells;
+	const V one = zero + 1;
+
+	V cost[B];
+	for(unsigned int b=0;b<B;b++)
+		cost[b] = zero;
+
+	for(unsigned int j=0;j<n_parts;j++){
+		const int *begin = machines_of.begin(j);
+		const int *end = machines_of.end(j);
+		if(begin == end)
+			continue;
+
+		V first[B];
+		V in[B];
+		for(unsigned int b=0;b<B;b++){
+			first[b] = none;
+			in[b] = zero;
+		}
+
+		for(const int *i=begin;i!=end;i++){
+			const int32_t *row = cells + (size_t)*i*W;
+			for(unsigned int b=0;b<B;b++){
+				V k;
+				memcpy(&k, row + b*VW, sizeof(V));
+				V lt = k < first[b];  // nueva primera celda: 1 máquina
+				V eq = k == first[b]; // otra máquina en la primera celda
+				in[b] = ((in[b] - eq) & ~lt) | (one & lt);
+				first[b] = (k & lt) | (first[b] & ~lt);
+			}
+		}
+
+		const V degree = zero + (int32_t)(end - begin);
+		for(unsigned int b=0;b<B;b++)
+			cost[b] += (degree - in[b]) & (first[b] < none);
+	}
+
+	for(unsigned int b=0;b<B;b++)
+		memcpy(exceptional + b*VW, &cost[b], sizeof(V));
+
+	if(n_cells > BATCH_SIMD_MAX_CELLS)
+		return;
+
+	V over[B];
+	for(unsigned int b=0;b<B;b++)
+		over[b] = zero;
+
+	const V max_cell = zero + (int32_t)max_machines_cell;
+	for(unsigned int c=0;c<n_cells;c++){
+		const V cell = zero + (int32_t)c;
+		V count[B];
+		for(unsigned int b=0;b<B;b++)
+			count[b] = zero;
+
+		for(unsigned int i=0;i<n_machines;i++){
+			const int32_t *row = cells + (size_t)i*W;
+			for(unsigned int b=0;b<B;b++){
+				V k;
+				memcpy(&k, row + b*VW, sizeof(V));
+				count[b] -= k == cell;
+			}
+		}
+
+		for(unsigned int b=0;b<B;b++){
+			V difference = count[b] - max_cell;
+			over[b] += difference & (difference > zero);
+		}
+	}
+
+	for(unsigned int b=0;b<B;b++)
+		memcpy(excess + b*VW, &over[b], sizeof(V));
+}
+
+static void kernel_portable(const int32_t *cells, const Adjacency &machines_of,
+		unsigned int n_machines, unsigned int n_parts, unsigned int n_cells,
+		unsigned int max_machines_cell, int32_t *exceptional, int32_t *excess) {
+	batch_kernel<v4si, 4>(cells, machines_of, n_machines, n_parts, n_cells,
+			max_machines_cell, exceptional, excess);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+static void kernel_avx2(const int32_t *cells, const Adjacency &machines_of,
+		unsigned int n_machines, unsigned int n_parts, unsigned int n_cells,
+		unsigned int max_machines_cell, int32_t *exceptional, int32_t *excess) {
+	batch_kernel<v8si, 8>(cells, machines_of, n_machines, n_parts, n_cells,
+			max_machines_cell, exceptional, excess);
+}
+
+__attribute__((target("avx512f")))
+static void kernel_avx512(const int32_t *cells, const Adjacency &machines_of,
+		unsigned int n_machines, unsigned int n_parts, unsigned int n_cells,
+		unsigned int max_machines_cell, int32_t *exceptional, int32_t *excess) {
+	batch_kernel<v16si, 16>(cells, machines_of, n_machines, n_parts, n_cells,
+			max_machines_cell, exceptional, excess);
+}
+#endif
+
+BatchEvaluator::BatchEvaluator(unsigned int n_machines, unsigned int n_parts,
+		unsigned int n_cells, unsigned int max_machines_cell,
+		const Adjacency &machines_of) {
+
+	this->isa = best_isa();
+	reset(n_machines, n_parts, n_cells, max_machines_cell, machines_of);
+}
+
+BatchEvaluator::~BatchEvaluator() {
+}
+
+void BatchEvaluator::reset(unsigned int n_machines, unsigned int n_parts,
+		unsigned int n_cells, unsigned int max_machines_cell,
+		const Adjacency &machines_of) {
+
+	this->n_machines = n_machines;
+	this->n_parts = n_parts;
+	this->n_cells = n_cells;
+	this->max_machines_cell = max_machines_cell;
+	this->machines_of = &machines_of;
+
+	cells.assign(n_machines*LANES, n_cells+1);
+	exceptional.assign(LANES, 0);
+	excess.assign(LANES, 0);
+	counts.assign(n_cells > BATCH_SIMD_MAX_CELLS ? n_cells : 0, 0);
+}
+
+int BatchEvaluator::best_isa() {
+#if defined(__x86_64__) || defined(__i386__)
+	if(__builtin_cpu_supports("avx512f"))
+		return BATCH_AVX512;
+	if(__builtin_cpu_supports("avx2"))
+		return BATCH_AVX2;
+#endif
+	return BATCH_PORTABLE;
+}
+
+const char *BatchEvaluator::isa_name(int isa) {
+	static const char *names[] = { "portable", "avx2", "avx512" };
+	return names[isa];
+}
+
+void BatchEvaluator::set(unsigned int lane, const int *cell_vector) {
+
+	// fuera de rango: mayor que cualquier celda, nunca es la primera
+	int32_t *column = &cells[lane];
+	for(unsigned int i=0;i<n_machines;i++){
+		int k = cell_vector[i];
+		column[(size_t)i*LANES] = (k < 0 || k >= (signed int)n_cells) ? n_cells+1 : k;
+	}
+}
+
+void BatchEvaluator::evaluate(unsigned int n_candidates, long *costs) {
+
+	const int32_t *data = cells.data();
+
+#if defined(__x86_64__) || defined(__i386__)
+	if(isa == BATCH_AVX512)
+		kernel_avx512(data, *machines_of, n_machines, n_parts, n_cells,
+				max_machines_cell, exceptional.data(), excess.data());
+	else if(isa == BATCH_AVX2)
+		kernel_avx2(data, *machines_of, n_machines, n_parts, n_cells,
+				max_machines_cell, exceptional.data(), excess.data());
+	else
+#endif
+		kernel_portable(data, *machines_of, n_machines, n_parts, n_cells,
+				max_machines_cell, exceptional.data(), excess.data());
+
+	if(n_cells > BATCH_SIMD_MAX_CELLS){
+		for(unsigned int l=0;l<n_candidates;l++){
+			std::fill(counts.begin(), counts.end(), 0);
+			for(unsigned int i=0;i<n_machines;i++){
+				int k = cells[(size_t)i*LANES + l];
+				if(k < (signed int)n_cells)
+					counts[k]++;
+			}
+			excess[l] = 0;
+			for(unsigned int k=0;k<n_cells;k++)
+				excess[l] += std::max(0, counts[k] - (signed int)max_machines_cell);
+		}
+	}
+
+	for(unsigned int l=0;l<n_candidates;l++)
+		costs[l] = (long)excess[l]*n_machines*n_parts + exceptional[l];
+}
+
+} /* namespace tabu */
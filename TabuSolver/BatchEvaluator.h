@@ -0,0 +1,56 @@
+#ifndef BATCHEVALUATOR_H_
+#define BATCHEVALUATOR_H_
+
+#include <vector>
+#include <stdint.h>
+#include "Matrix.h"
+
+namespace tabu {
+
+// conjunto de instrucciones de los kernels de BatchEvaluator
+enum BatchIsa {
+	BATCH_PORTABLE,
+	BATCH_AVX2,
+	BATCH_AVX512
+};
+
+/*
+ * Costo completo (igual a Solver::get_cost) de hasta LANES soluciones a la
+ * vez. Las candidatas se guardan en formato SoA: la fila de la máquina i
+ * tiene la celda de esa máquina en cada candidata, cells[i*LANES + l], y
+ * los kernels recorren el índice parte -> máquinas una sola vez con una
+ * candidata por lane SIMD (un vector de 16 en AVX-512, dos de 8 en AVX2,
+ * vectores genéricos de 4 en el código portable). set() traspone un
+ * cell_vector y deja las celdas fuera de rango como n_cells+1, así el
+ * kernel no tiene ramas. El ISA se elige en tiempo de ejecución según la
+ * CPU; isa puede bajarse a mano (p. ej. para comparar).
+ */
+class BatchEvaluator {
+public:
+	static const unsigned int LANES = 16;
+	BatchEvaluator(unsigned int n_machines, unsigned int n_parts,
+			unsigned int n_cells, unsigned int max_machines_cell,
+			const Adjacency &machines_of);
+	virtual ~BatchEvaluator();
+	void reset(unsigned int n_machines, unsigned int n_parts,
+			unsigned int n_cells, unsigned int max_machines_cell,
+			const Adjacency &machines_of);
+	void set(unsigned int lane, const int *cell_vector);
+	void evaluate(unsigned int n_candidates, long *costs);
+	static int best_isa();
+	static const char *isa_name(int isa);
+	int isa;
+private:
+	unsigned int n_machines;
+	unsigned int n_parts;
+	unsigned int n_cells;
+	unsigned int max_machines_cell;
+	const Adjacency *machines_of;
+	std::vector<int32_t> cells;       // n_machines * LANES
+	std::vector<int32_t> exceptional; // LANES
+	std::vector<int32_t> excess;      // LANES, máquinas sobre el máximo
+	std::vector<int32_t> counts;      // histograma escalar con muchas celdas
+};
+
+} /* namespace tabu */
+#endif /* BATCHEVALUATOR_H_ */
@@ -0,0 +1,218 @@
+/*
+ * tabu_bench: corre cada backend sobre un conjunto de instancias con
+ * semillas fijas y reporta una tabla separada por tabs con iteraciones/s,
+ * evaluaciones de vecinos/s, tiempo de pared hasta cada costo objetivo y
+ * la distribución de costos finales.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include "InstanceParser.h"
+#include "Solver.h"
+#include "ThreadedSolver.h"
+#include "ParallelSolver.h"
+#include "Matrix.h"
+
+typedef struct bench_run {
+
+	std::string backend;
+	unsigned int seed;
+	unsigned int iterations;
+	unsigned long evaluations;
+	double seconds;
+	int final_cost;
+	std::vector<std::pair<double,int> > improvements;
+} BenchRun;
+
+static std::vector<std::string> split(const std::string &list) {
+	std::vector<std::string> items;
+	std::string::size_type start = 0;
+	while(start <= list.size()){
+		std::string::size_type end = list.find(',', start);
+		if(end == std::string::npos)
+			end = list.size();
+		if(end > start)
+			items.push_back(list.substr(start, end-start));
+		start = end+1;
+	}
+	return items;
+}
+
+// primer instante en que la mejor solución global alcanzó target (-1 si no)
+static double time_to_target(const BenchRun &run, int target) {
+	for(unsigned int k=0;k<run.improvements.size();k++){
+		if(run.improvements[k].second <= target)
+			return run.improvements[k].first;
+	}
+	return -1;
+}
+
+int main(int argc, char* argv[]) {
+
+	int iterations = 1000;
+	int diversification_param = 2;
+	int cells = 2;
+	int max_machines_cell = 8;
+	int tabu_turns = 100;
+	int runs = 5;
+	int threads = 0;
+	std::string backends = "serial,threaded,opencl";
+	std::string targets_arg = "";
+	int c;
+
+	while ((c = getopt(argc, argv, "i:d:c:m:t:r:T:b:g:")) != -1){
+		switch (c) {
+		case 'i': iterations = atoi(optarg); break;
+		case 'd': diversification_param = atoi(optarg); break;
+		case 'c': cells = atoi(optarg); break;
+		case 'm': max_machines_cell = atoi(optarg); break;
+		case 't': tabu_turns = atoi(optarg); break;
+		case 'r': runs = atoi(optarg); break;
+		case 'T': threads = atoi(optarg); break;
+		case 'b': backends.assign(optarg, strlen(optarg)); break;
+		case 'g': targets_arg.assign(optarg, strlen(optarg)); break;
+		default:
+			std::cout << "argumentos : [-i <iteraciones>] [-d <diversificacion>] [-c <celdas>] [-m <máquinas max por celda>] [-t <turnos tabu>] "
+					"[-r <corridas>] [-T <hilos>] [-b serial,generic,threaded,opencl] [-g <costos objetivo>] <instancias...>\n";
+			return 1;
+		}
+	}
+
+	std::vector<std::string> backend_list = split(backends);
+	std::vector<std::string> target_list = split(targets_arg);
+
+	printf("#run\tinstance\tbackend\tseed\titerations\tseconds\titer_per_s\tevals_per_s\tfinal_cost\ttarget\ttime_to_target\n");
+
+	std::vector<std::string> summaries;
+
+	for(int f=optind;f<argc;f++){
+
+		tabu::InstanceParser parser;
+		tabu::Matrix *mat = parser.parse_input(argv[f]);
+		if(mat == NULL){
+			fprintf(stderr, "%s\n", parser.error.c_str());
+			continue;
+		}
+
+		std::vector<BenchRun> results;
+
+		for(unsigned int b=0;b<backend_list.size();b++){
+			for(int r=1;r<=runs;r++){
+
+				tabu::Solver *solver = NULL;
+				const std::string &backend = backend_list[b];
+
+				if(backend == "serial" || backend == "generic")
+					solver = new tabu::Solver(iterations, diversification_param,
+							parser.machines, parser.parts, cells, max_machines_cell, mat, tabu_turns);
+				else if(backend == "threaded")
+					solver = new tabu::ThreadedSolver(iterations, diversification_param,
+							parser.machines, parser.parts, cells, max_machines_cell, mat, tabu_turns, threads);
+				else if(backend == "opencl")
+					solver = new tabu::ParallelSolver(iterations, diversification_param,
+							parser.machines, parser.parts, cells, max_machines_cell, mat, tabu_turns);
+				else{
+					fprintf(stderr, "backend desconocido: %s\n", backend.c_str());
+					return 1;
+				}
+
+				// generic: serial sin los kernels de tamaño fijo
+				solver->fixed_kernels = backend != "generic";
+				solver->seed = r;
+				solver->verbosity = tabu::TRACE_NONE;
+				solver->solve();
+
+				BenchRun run;
+				run.backend = backend;
+				run.seed = r;
+				run.iterations = solver->n_iterations;
+				run.evaluations = solver->n_evaluations;
+				run.seconds = solver->elapsed_time;
+				run.final_cost = solver->global_best_cost;
+				run.improvements = solver->improvements;
+				results.push_back(run);
+
+				delete solver;
+			}
+		}
+
+		// objetivos: los de -g, o el mejor costo final de la instancia
+		std::vector<int> targets;
+		for(unsigned int t=0;t<target_list.size();t++)
+			targets.push_back(atoi(target_list[t].c_str()));
+		if(targets.empty()){
+			int best = results.empty() ? 0 : results[0].final_cost;
+			for(unsigned int k=0;k<results.size();k++)
+				best = std::min(best, results[k].final_cost);
+			targets.push_back(best);
+		}
+
+		for(unsigned int k=0;k<results.size();k++){
+			const BenchRun &run = results[k];
+			for(unsigned int t=0;t<targets.size();t++){
+				printf("run\t%s\t%s\t%u\t%u\t%.6f\t%.1f\t%.1f\t%i\t%i\t%.6f\n", argv[f],
+						run.backend.c_str(), run.seed, run.iterations, run.seconds,
+						run.iterations/run.seconds, run.evaluations/run.seconds,
+						run.final_cost, targets[t], time_to_target(run, targets[t]));
+			}
+		}
+
+		for(unsigned int b=0;b<backend_list.size();b++){
+
+			std::vector<int> costs;
+			double iter_rate = 0;
+			double eval_rate = 0;
+			for(unsigned int k=0;k<results.size();k++){
+				if(results[k].backend != backend_list[b])
+					continue;
+				costs.push_back(results[k].final_cost);
+				iter_rate += results[k].iterations/results[k].seconds;
+				eval_rate += results[k].evaluations/results[k].seconds;
+			}
+			if(costs.empty())
+				continue;
+			std::sort(costs.begin(), costs.end());
+
+			double mean = 0;
+			for(unsigned int k=0;k<costs.size();k++)
+				mean += costs[k];
+			mean /= costs.size();
+
+			for(unsigned int t=0;t<targets.size();t++){
+				int hits = 0;
+				double ttt = 0;
+				for(unsigned int k=0;k<results.size();k++){
+					if(results[k].backend != backend_list[b])
+						continue;
+					double time = time_to_target(results[k], targets[t]);
+					if(time >= 0){
+						hits++;
+						ttt += time;
+					}
+				}
+
+				char line[512];
+				snprintf(line, sizeof(line), "summary\t%s\t%s\t%u\t%i\t%i\t%.2f\t%i\t%.1f\t%.1f\t%i\t%i\t%.6f",
+						argv[f], backend_list[b].c_str(), (unsigned int)costs.size(),
+						costs.front(), costs[costs.size()/2], mean, costs.back(),
+						iter_rate/costs.size(), eval_rate/costs.size(),
+						targets[t], hits, hits > 0 ? ttt/hits : -1.0);
+				summaries.push_back(line);
+			}
+		}
+
+		delete mat;
+	}
+
+	printf("#summary\tinstance\tbackend\truns\tcost_min\tcost_median\tcost_mean\tcost_max\titer_per_s\tevals_per_s\ttarget\thits\tmean_time_to_target\n");
+	for(unsigned int k=0;k<summaries.size();k++)
+		printf("%s\n", summaries[k].c_str());
+
+	return EXIT_SUCCESS;
+}
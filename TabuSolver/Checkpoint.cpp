@@ -0,0 +1,131 @@
+#include "Checkpoint.h"
+#include "Hash.h"
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace tabu {
+
+uint64_t checkpoint_checksum(const std::vector<int32_t> &payload) {
+	return fnv1a_hash(payload.data(), payload.size()*sizeof(int32_t));
+}
+
+bool read_checkpoint(const char *filename, CheckpointState &state,
+		std::string &error) {
+
+	FILE *file;
+	if((file = fopen(filename, "rb")) == NULL){
+		error = std::string(filename) + ": no se pudo abrir el archivo";
+		return false;
+	}
+
+	struct stat st;
+	CheckpointHeader &h = state.header;
+	bool ok = fstat(fileno(file), &st) == 0 &&
+			fread(&h, sizeof(h), 1, file) == 1;
+
+	if(!ok || memcmp(h.magic, CHECKPOINT_MAGIC, 8) != 0)
+		error = std::string(filename) + ": no es un checkpoint";
+	else if(h.version != CHECKPOINT_VERSION)
+		error = std::string(filename) + ": versión de checkpoint no soportada";
+	else if(h.byte_order != CHECKPOINT_BYTE_ORDER || h.header_size != sizeof(h))
+		error = std::string(filename) + ": checkpoint de otra arquitectura";
+	else if(h.payload_size != (2*(uint64_t)h.n_machines +
+			((uint64_t)h.tabu_size + h.elite_count)*(1 + h.n_machines))*sizeof(int32_t))
+		error = std::string(filename) + ": tamaño de payload inconsistente";
+	// antes de reservar: un encabezado corrupto no debe pedir más que el archivo
+	else if(sizeof(h) + h.payload_size != (uint64_t)st.st_size)
+		error = std::string(filename) + ": checkpoint truncado";
+	else {
+		state.payload.resize(h.payload_size/sizeof(int32_t));
+		if(fread(state.payload.data(), 1, h.payload_size, file) != h.payload_size)
+			error = std::string(filename) + ": checkpoint truncado";
+		else if(checkpoint_checksum(state.payload) != h.checksum)
+			error = std::string(filename) + ": checksum inválido";
+		else {
+			fclose(file);
+			return true;
+		}
+	}
+
+	fclose(file);
+	return false;
+}
+
+CheckpointWriter::CheckpointWriter(const std::string &filename) {
+	this->filename = filename;
+	this->has_pending = false;
+	this->closing = false;
+	this->failed = false;
+
+	writer = std::thread(&CheckpointWriter::writer_loop, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+	close();
+}
+
+void CheckpointWriter::submit(CheckpointState &state) {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::swap(pending, state);
+	has_pending = true;
+	ready.notify_one();
+}
+
+void CheckpointWriter::close() {
+	if(!writer.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		closing = true;
+	}
+	ready.notify_one();
+	writer.join();
+}
+
+void CheckpointWriter::writer_loop() {
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while(true){
+		while(!has_pending && !closing)
+			ready.wait(lock);
+
+		if(!has_pending)
+			break;
+
+		std::swap(writing, pending);
+		has_pending = false;
+		lock.unlock();
+
+		if(!write_file(writing) && !failed){
+			fprintf(stderr, "%s: no se pudo escribir el checkpoint\n",
+					filename.c_str());
+			failed = true;
+		}
+
+		lock.lock();
+	}
+}
+
+bool CheckpointWriter::write_file(CheckpointState &state) {
+
+	CheckpointHeader &h = state.header;
+	h.payload_size = state.payload.size()*sizeof(int32_t);
+	h.checksum = checkpoint_checksum(state.payload);
+
+	std::string tmp = filename + ".tmp";
+	FILE *file;
+	if((file = fopen(tmp.c_str(), "wb")) == NULL)
+		return false;
+
+	bool ok = fwrite(&h, sizeof(h), 1, file) == 1 &&
+			fwrite(state.payload.data(), 1, h.payload_size, file) == h.payload_size;
+	ok = fflush(file) == 0 && ok;
+	ok = fsync(fileno(file)) == 0 && ok;
+	ok = fclose(file) == 0 && ok;
+
+	return ok && rename(tmp.c_str(), filename.c_str()) == 0;
+}
+
+} /* namespace tabu */
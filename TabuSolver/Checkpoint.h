@@ -0,0 +1,106 @@
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+
+namespace tabu {
+
+/*
+ * Checkpoint del estado completo de una búsqueda (version 3, en el orden de
+ * bytes de la máquina que lo escribió). Tras el encabezado va el payload de
+ * int32_t:
+ *   current      n_machines, cell_vector de la solución actual
+ *   global_best  n_machines
+ *   tabu         tabu_size * (1 + n_machines), expiración y cell_vector de
+ *                cada entrada de la lista tabú, de la más antigua a la más nueva
+ *   elites       elite_count * (1 + n_machines), costo y cell_vector de cada
+ *                élite del pool, en el orden del pool
+ * checksum es FNV-1a de 64 bits del payload. Los parámetros del encabezado
+ * deben coincidir con los de la corrida que lo reanuda, salvo max_iterations
+ * (puede extenderse) y la semilla, que se toma del checkpoint.
+ */
+#define CHECKPOINT_MAGIC "TABUCKPT"
+#define CHECKPOINT_VERSION 3
+#define CHECKPOINT_BYTE_ORDER 0x01020304
+
+typedef struct checkpoint_header {
+
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t header_size;
+	// parámetros de la corrida
+	uint32_t n_machines;
+	uint32_t n_parts;
+	uint32_t n_cells;
+	uint32_t max_machines_cell;
+	int32_t tabu_turns;
+	int32_t diversification_param;
+	uint32_t candidate_list_period;
+	uint32_t diversification_candidates;
+	uint32_t elite_size;
+	uint32_t relink_period;
+	uint64_t nnz;
+	uint32_t seed;
+	// estado de la búsqueda
+	uint32_t n_iterations;
+	uint32_t last_improvement;
+	uint32_t rand_state;
+	int32_t current_cost;
+	int32_t global_best_cost;
+	uint32_t tabu_turn;
+	uint32_t tabu_size;
+	uint32_t elite_count;
+	uint64_t n_evaluations;
+	double elapsed_time;
+	uint64_t payload_size; // bytes tras el encabezado
+	uint64_t checksum;
+} CheckpointHeader;
+
+typedef struct checkpoint_state {
+
+	CheckpointHeader header;
+	std::vector<int32_t> payload;
+} CheckpointState;
+
+uint64_t checkpoint_checksum(const std::vector<int32_t> &payload);
+
+// lee y verifica un checkpoint; false y el motivo en error si no es válido
+bool read_checkpoint(const char *filename, CheckpointState &state,
+		std::string &error);
+
+/*
+ * Escritor asíncrono de checkpoints. submit() intercambia el estado con el
+ * buffer pendiente (sin copias ni asignaciones en régimen) y un hilo de
+ * fondo lo escribe en filename.tmp y lo renombra a filename, de modo que
+ * el archivo siempre contiene un checkpoint completo. Si llega un estado
+ * nuevo antes de que se escriba el anterior, éste se descarta. close() (o
+ * el destructor) escribe el último pendiente y termina el hilo.
+ */
+class CheckpointWriter {
+public:
+	CheckpointWriter(const std::string &filename);
+	virtual ~CheckpointWriter();
+	void submit(CheckpointState &state);
+	void close();
+private:
+	void writer_loop();
+	bool write_file(CheckpointState &state);
+	std::string filename;
+	CheckpointState pending;
+	CheckpointState writing;
+	bool has_pending;
+	bool closing;
+	bool failed;
+	std::mutex mutex;
+	std::condition_variable ready;
+	std::thread writer;
+};
+
+} /* namespace tabu */
+#endif /* CHECKPOINT_H_ */
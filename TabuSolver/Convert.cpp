@@ -0,0 +1,71 @@
+/*
+ * tabu_convert: convierte instancias de texto al formato binario de
+ * InstanceParser (ver BinaryInstanceHeader). Cada archivo x.txt se escribe
+ * como x.bin, o en la salida dada con -o si hay una sola entrada.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include "InstanceParser.h"
+#include "Matrix.h"
+
+static std::string binary_name(const std::string &input) {
+	std::string::size_type dot = input.rfind('.');
+	std::string::size_type slash = input.rfind('/');
+	if(dot == std::string::npos || (slash != std::string::npos && dot < slash))
+		return input + ".bin";
+	return input.substr(0, dot) + ".bin";
+}
+
+int main(int argc, char* argv[]) {
+
+	std::string output = "";
+	int c;
+
+	while ((c = getopt(argc, argv, "o:")) != -1){
+		switch (c) {
+		case 'o': output.assign(optarg, strlen(optarg)); break;
+		default:
+			std::cout << "argumentos : [-o <salida>] <instancias...>\n";
+			return 1;
+		}
+	}
+
+	if(optind == argc || (!output.empty() && argc-optind > 1)){
+		std::cout << "argumentos : [-o <salida>] <instancias...>\n";
+		return 1;
+	}
+
+	int failed = 0;
+
+	for(int f=optind;f<argc;f++){
+
+		tabu::InstanceParser parser;
+		tabu::Matrix *mat = parser.parse_input(argv[f]);
+		if(mat == NULL){
+			fprintf(stderr, "%s\n", parser.error.c_str());
+			failed++;
+			continue;
+		}
+
+		std::string target = output.empty() ? binary_name(argv[f]) : output;
+		if(target == argv[f]){
+			fprintf(stderr, "%s: la salida sobrescribiría la entrada\n", argv[f]);
+			failed++;
+		} else if(!parser.write_binary(mat, target.c_str())){
+			fprintf(stderr, "%s\n", parser.error.c_str());
+			failed++;
+		} else {
+			printf("%s -> %s (%d x %d, %d unos)\n", argv[f], target.c_str(),
+					mat->rows, mat->cols, mat->row_index().offsets[mat->rows]);
+		}
+
+		delete mat;
+	}
+
+	return failed == 0 ? EXIT_SUCCESS : 1;
+}
@@ -0,0 +1,214 @@
+#include "DeltaEvaluator.h"
+#include <algorithm>
+
+namespace tabu {
+
+DeltaEvaluator::DeltaEvaluator(unsigned int n_machines, unsigned int n_parts,
+		unsigned int n_cells, unsigned int max_machines_cell,
+		const Adjacency &parts_machines) {
+
+	reset(n_machines, n_parts, n_cells, max_machines_cell, parts_machines);
+}
+
+DeltaEvaluator::~DeltaEvaluator() {
+}
+
+void DeltaEvaluator::reset(unsigned int n_machines, unsigned int n_parts,
+		unsigned int n_cells, unsigned int max_machines_cell,
+		const Adjacency &parts_machines) {
+
+	this->parts_machines = &parts_machines;
+	this->cost = -1;
+	this->n_machines = n_machines;
+	this->n_parts = n_parts;
+	this->n_cells = n_cells;
+	this->max_machines_cell = max_machines_cell;
+
+	cells.assign(n_machines, 0);
+	part_cell_count.assign(n_parts*n_cells, 0);
+	part_degree.assign(n_parts, 0);
+	part_costs.assign(n_parts, 0);
+	part_owner.assign(n_parts, -1);
+	machines_cell.assign(n_cells, 0);
+
+	for(unsigned int i=0;i<n_machines;i++){
+		for(const int *p=parts_machines.begin(i);p!=parts_machines.end(i);p++)
+			part_degree[*p]++;
+	}
+}
+
+long DeltaEvaluator::load(Solution *solution) {
+
+	std::fill(part_cell_count.begin(), part_cell_count.end(), 0);
+	std::fill(machines_cell.begin(), machines_cell.end(), 0);
+
+	for(unsigned int i=0;i<n_machines;i++){
+		int k = solution->cell_vector[i];
+		cells[i] = k;
+
+		// máquinas fuera de rango no pertenecen a ninguna celda (como en get_cost)
+		if(k < 0 || k >= (signed int)n_cells)
+			continue;
+
+		machines_cell[k]++;
+		for(const int *p=parts_machines->begin(i);p!=parts_machines->end(i);p++)
+			part_cell_count[*p*n_cells+k]++;
+	}
+
+	cost = 0;
+
+	for(unsigned int k=0;k<n_cells;k++){
+		int difference = machines_cell[k] - max_machines_cell;
+		if(difference > 0)
+			cost += (difference)*n_machines*n_parts;
+	}
+
+	for(unsigned int j=0;j<n_parts;j++){
+		part_costs[j] = part_cost(j, -1, -1);
+		cost += part_costs[j];
+
+		part_owner[j] = -1;
+		for(unsigned int k=0;k<n_cells;k++){
+			if(part_cell_count[j*n_cells+k] > 0){
+				part_owner[j] = k;
+				break;
+			}
+		}
+	}
+
+	return cost;
+}
+
+long DeltaEvaluator::part_cost(unsigned int part, int from, int to) const {
+
+	// costo de la parte si una de sus máquinas pasa de la celda from a la celda to
+	const int *count = &part_cell_count[part*n_cells];
+
+	for(unsigned int k=0;k<n_cells;k++){
+		int machines_in = count[k];
+		if((signed int)k == from)
+			machines_in--;
+		if((signed int)k == to)
+			machines_in++;
+
+		if(machines_in > 0) // primera celda con la parte
+			return part_degree[part] - machines_in;
+	}
+
+	return 0;
+}
+
+long DeltaEvaluator::penalty(int machines) const {
+
+	int difference = machines - max_machines_cell;
+	if(difference > 0)
+		return (difference)*n_machines*n_parts;
+	return 0;
+}
+
+long DeltaEvaluator::move_delta(unsigned int i, int to) const {
+
+	int from = cells[i];
+	if(from == to)
+		return 0;
+
+	// sólo cambian las celdas from y to (fuera de rango no cuentan)
+	long delta = 0;
+	if(from >= 0 && from < (signed int)n_cells)
+		delta += penalty(machines_cell[from]-1) - penalty(machines_cell[from]);
+	if(to >= 0 && to < (signed int)n_cells)
+		delta += penalty(machines_cell[to]+1) - penalty(machines_cell[to]);
+
+	for(const int *p=parts_machines->begin(i);p!=parts_machines->end(i);p++)
+		delta += part_cost(*p, from, to) - part_costs[*p];
+
+	return delta;
+}
+
+void DeltaEvaluator::move(unsigned int i, int to) {
+
+	int from = cells[i];
+	if(from == to)
+		return;
+
+	cost += move_delta(i, to);
+
+	bool from_in = from >= 0 && from < (signed int)n_cells;
+	bool to_in = to >= 0 && to < (signed int)n_cells;
+	if(from_in)
+		machines_cell[from]--;
+	if(to_in)
+		machines_cell[to]++;
+
+	// sólo las partes de la máquina i cambian de conteo, costo y dueña
+	for(const int *p=parts_machines->begin(i);p!=parts_machines->end(i);p++){
+		int *count = &part_cell_count[*p*n_cells];
+		if(from_in)
+			count[from]--;
+		if(to_in)
+			count[to]++;
+
+		part_costs[*p] = part_cost(*p, -1, -1);
+		part_owner[*p] = -1;
+		for(unsigned int k=0;k<n_cells;k++){
+			if(count[k] > 0){
+				part_owner[*p] = k;
+				break;
+			}
+		}
+	}
+
+	cells[i] = to;
+}
+
+bool DeltaEvaluator::candidate(unsigned int machine) const {
+
+	// máquina en una celda sobre max_machines_cell
+	int k = cells[machine];
+	if(k >= 0 && k < (signed int)n_cells && machines_cell[k] > (signed int)max_machines_cell)
+		return true;
+
+	// máquina con algún elemento excepcional (parte de otra celda)
+	for(const int *p=parts_machines->begin(machine);p!=parts_machines->end(machine);p++){
+		if(part_owner[*p] != k)
+			return true;
+	}
+
+	return false;
+}
+
+long DeltaEvaluator::swap_delta(unsigned int i, unsigned int j) const {
+
+	int cell_i = cells[i];
+	int cell_j = cells[j];
+
+	if(cell_i == cell_j)
+		return 0;
+
+	// las partes que usan ambas máquinas no cambian de conteo
+	const int *x = parts_machines->begin(i);
+	const int *end_x = parts_machines->end(i);
+	const int *y = parts_machines->begin(j);
+	const int *end_y = parts_machines->end(j);
+	long delta = 0;
+
+	while(x != end_x || y != end_y){
+
+		if(y == end_y || (x != end_x && *x < *y)){
+			int part = *x++;
+			delta += part_cost(part, cell_i, cell_j) - part_costs[part];
+		}
+		else if(x == end_x || *y < *x){
+			int part = *y++;
+			delta += part_cost(part, cell_j, cell_i) - part_costs[part];
+		}
+		else{
+			x++;
+			y++;
+		}
+	}
+
+	return delta;
+}
+
+} /* namespace tabu */
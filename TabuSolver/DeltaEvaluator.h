@@ -0,0 +1,58 @@
+#ifndef DELTAEVALUATOR_H_
+#define DELTAEVALUATOR_H_
+
+#include <vector>
+#include "Solution.h"
+#include "Matrix.h"
+
+namespace tabu {
+
+/*
+ * Evaluación incremental de intercambios (swap) de máquinas.
+ *
+ * Mantiene, para la solución cargada, la tabla partes x celdas con el número
+ * de máquinas de cada celda que procesan la parte. El costo de una parte es
+ * (máquinas que la usan) - (máquinas de la primera celda que la usa), igual
+ * que en Solver::get_cost, por lo que un swap (i,j) sólo cambia el costo de
+ * las partes de parts_machines[i] y parts_machines[j]. Un swap no cambia el
+ * tamaño de las celdas, así que la penalización por max_machines_cell se
+ * mantiene. move_delta() y move() cambian de celda una sola máquina, lo que
+ * sí cambia la penalización; move() actualiza las tablas sin volver a
+ * cargar la solución.
+ *
+ * parts_machines debe estar ordenado de forma ascendente por parte. reset()
+ * cambia de instancia reutilizando las tablas, que sólo crecen.
+ */
+class DeltaEvaluator {
+public:
+	DeltaEvaluator(unsigned int n_machines, unsigned int n_parts,
+			unsigned int n_cells, unsigned int max_machines_cell,
+			const Adjacency &parts_machines);
+	virtual ~DeltaEvaluator();
+	void reset(unsigned int n_machines, unsigned int n_parts,
+			unsigned int n_cells, unsigned int max_machines_cell,
+			const Adjacency &parts_machines);
+	long load(Solution *solution);
+	long swap_delta(unsigned int i, unsigned int j) const;
+	long move_delta(unsigned int i, int to) const;
+	void move(unsigned int i, int to);
+	bool candidate(unsigned int machine) const;
+	long cost;
+private:
+	long part_cost(unsigned int part, int from, int to) const;
+	long penalty(int machines) const;
+	unsigned int n_machines;
+	unsigned int n_parts;
+	unsigned int n_cells;
+	unsigned int max_machines_cell;
+	const Adjacency *parts_machines;
+	std::vector<int> cells;               // celda de cada máquina
+	std::vector<int> part_cell_count;     // n_parts * n_cells
+	std::vector<int> part_degree;         // máquinas que usan la parte
+	std::vector<long> part_costs;         // costo actual de cada parte
+	std::vector<int> part_owner;          // primera celda con la parte, -1 si ninguna
+	std::vector<int> machines_cell;       // máquinas por celda
+};
+
+} /* namespace tabu */
+#endif /* DELTAEVALUATOR_H_ */
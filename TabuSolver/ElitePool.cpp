@@ -0,0 +1,129 @@
+#include "ElitePool.h"
+#include <algorithm>
+
+namespace tabu {
+
+ElitePool::ElitePool(unsigned int capacity, unsigned int n_machines,
+		unsigned int n_cells, unsigned int min_distance) {
+
+	reset(capacity, n_machines, n_cells, min_distance);
+}
+
+ElitePool::~ElitePool() {
+}
+
+void ElitePool::reset(unsigned int capacity, unsigned int n_machines,
+		unsigned int n_cells, unsigned int min_distance) {
+
+	this->capacity = capacity;
+	this->n_machines = n_machines;
+	this->n_cells = n_cells;
+	this->min_distance = std::max(1u, min_distance);
+	this->count = 0;
+
+	elite_cells.resize((size_t)capacity*n_machines);
+	canonical.resize((size_t)capacity*n_machines);
+	costs.resize(capacity);
+	candidate.resize(n_machines);
+	labels.resize(n_cells+1);
+}
+
+void ElitePool::canonicalize(const int *cells, int *out) {
+
+	// las celdas fuera de rango son una sola (n_cells)
+	std::fill(labels.begin(), labels.end(), -1);
+	int next = 0;
+	for(unsigned int i=0;i<n_machines;i++){
+		int k = cells[i];
+		if(k < 0 || k >= (signed int)n_cells)
+			k = n_cells;
+		if(labels[k] < 0)
+			labels[k] = next++;
+		out[i] = labels[k];
+	}
+}
+
+unsigned int ElitePool::distance(const int *a, const int *b,
+		unsigned int limit) const {
+
+	// sólo interesa saber si es menor que limit
+	unsigned int d = 0;
+	for(unsigned int i=0;i<n_machines && d<limit;i++)
+		d += a[i] != b[i];
+	return d;
+}
+
+void ElitePool::store(unsigned int k, const int *cells, long cost) {
+
+	std::copy(cells, cells+n_machines, &elite_cells[(size_t)k*n_machines]);
+	std::copy(candidate.begin(), candidate.end(), &canonical[(size_t)k*n_machines]);
+	costs[k] = cost;
+}
+
+bool ElitePool::insert(const int *cells, long cost) {
+
+	if(capacity == 0)
+		return false;
+
+	unsigned int worst = 0;
+	for(unsigned int k=1;k<count;k++){
+		if(costs[k] > costs[worst])
+			worst = k;
+	}
+
+	// pool lleno y no mejora a la peor: no hace falta compararla
+	if(count == capacity && cost >= costs[worst])
+		return false;
+
+	canonicalize(cells, &candidate[0]);
+
+	// élite más cercana dentro de min_distance
+	int closest = -1;
+	unsigned int closest_distance = min_distance;
+	for(unsigned int k=0;k<count;k++){
+		unsigned int d = distance(&candidate[0], &canonical[(size_t)k*n_machines],
+				closest_distance);
+		if(d < closest_distance){
+			closest = k;
+			closest_distance = d;
+		}
+	}
+
+	if(closest >= 0){
+		if(cost >= costs[closest])
+			return false;
+		store(closest, cells, cost);
+	}
+	else if(count < capacity)
+		store(count++, cells, cost);
+	else
+		store(worst, cells, cost);
+
+	return true;
+}
+
+void ElitePool::save(int *out) const {
+
+	// costo y cell_vector de cada élite, en el orden del pool
+	for(unsigned int k=0;k<count;k++){
+		*out++ = costs[k];
+		std::copy(cells(k), cells(k)+n_machines, out);
+		out += n_machines;
+	}
+}
+
+bool ElitePool::restore(unsigned int n_elites, const int *data) {
+
+	if(n_elites > capacity)
+		return false;
+
+	for(count=0;count<n_elites;count++){
+		const int *cells = data+1;
+		canonicalize(cells, &candidate[0]);
+		store(count, cells, *data);
+		data += 1+n_machines;
+	}
+	return true;
+}
+
+} /* namespace tabu */
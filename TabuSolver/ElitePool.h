@@ -0,0 +1,60 @@
+#ifndef ELITEPOOL_H_
+#define ELITEPOOL_H_
+
+#include <vector>
+#include <stddef.h>
+
+namespace tabu {
+
+/*
+ * Las capacity mejores soluciones distintas vistas por la búsqueda. La
+ * diversidad se mide con la distancia de Hamming entre cell_vectors con las
+ * celdas renombradas por orden de aparición (dos soluciones que sólo
+ * difieren en los nombres de las celdas están a distancia 0). Una solución
+ * a menos de min_distance de una élite sólo entra reemplazándola, y sólo si
+ * es mejor; si no, con el pool lleno reemplaza a la peor. Se guardan los
+ * cell_vector originales: el costo depende del orden de las celdas.
+ */
+class ElitePool {
+public:
+	ElitePool(unsigned int capacity, unsigned int n_machines,
+			unsigned int n_cells, unsigned int min_distance);
+	virtual ~ElitePool();
+	void reset(unsigned int capacity, unsigned int n_machines,
+			unsigned int n_cells, unsigned int min_distance);
+	bool insert(const int *cells, long cost);
+	unsigned int size() const;
+	const int *cells(unsigned int k) const;
+	long cost(unsigned int k) const;
+	void save(int *out) const;
+	bool restore(unsigned int n_elites, const int *data);
+private:
+	void canonicalize(const int *cells, int *out);
+	unsigned int distance(const int *a, const int *b, unsigned int limit) const;
+	void store(unsigned int k, const int *cells, long cost);
+	unsigned int capacity;
+	unsigned int n_machines;
+	unsigned int n_cells;
+	unsigned int min_distance;
+	unsigned int count;
+	std::vector<int> elite_cells;   // capacity * n_machines
+	std::vector<int> canonical;     // capacity * n_machines, renombradas
+	std::vector<long> costs;
+	std::vector<int> candidate;     // candidata renombrada
+	std::vector<int> labels;        // celda original -> celda renombrada
+};
+
+inline unsigned int ElitePool::size() const {
+	return count;
+}
+
+inline const int *ElitePool::cells(unsigned int k) const {
+	return &elite_cells[(size_t)k*n_machines];
+}
+
+inline long ElitePool::cost(unsigned int k) const {
+	return costs[k];
+}
+
+} /* namespace tabu */
+#endif /* ELITEPOOL_H_ */
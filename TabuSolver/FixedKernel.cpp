@@ -0,0 +1,27 @@
+#include "FixedKernel.h"
+
+namespace tabu {
+
+int fixed_kernel_size(unsigned int n_machines, unsigned int n_parts,
+		unsigned int n_cells) {
+
+	if(n_machines <= 16 && n_parts <= 32 && n_cells <= 4)
+		return FIXED_16x32x4;
+	if(n_machines <= 32 && n_parts <= 64 && n_cells <= 8)
+		return FIXED_32x64x8;
+	if(n_machines <= 64 && n_parts <= 128 && n_cells <= 16)
+		return FIXED_64x128x16;
+	return FIXED_NONE;
+}
+
+FixedKernelBase *create_fixed_kernel(int size) {
+
+	switch(size){
+	case FIXED_16x32x4: return new FixedKernel16x32x4();
+	case FIXED_32x64x8: return new FixedKernel32x64x8();
+	case FIXED_64x128x16: return new FixedKernel64x128x16();
+	default: return NULL;
+	}
+}
+
+} /* namespace tabu */
@@ -0,0 +1,229 @@
+#ifndef FIXEDKERNEL_H_
+#define FIXEDKERNEL_H_
+
+#include <array>
+#include <stdint.h>
+#include "Solution.h"
+#include "Matrix.h"
+
+namespace tabu {
+
+// especializaciones de FixedKernel, de menor a mayor
+enum FixedSize {
+	FIXED_NONE,      // instancia grande: DeltaEvaluator genérico
+	FIXED_16x32x4,
+	FIXED_32x64x8,
+	FIXED_64x128x16
+};
+
+// parte no dependiente del tamaño, para guardarlo en el Solver
+class FixedKernelBase {
+public:
+	virtual ~FixedKernelBase() {}
+	virtual void reset(unsigned int n_machines, unsigned int n_parts,
+			unsigned int n_cells, unsigned int max_machines_cell,
+			const Adjacency &parts_machines) = 0;
+	virtual long evaluate(const int *cell_vector) const = 0;
+};
+
+/*
+ * Evaluación completa e incremental (misma interfaz que DeltaEvaluator) para
+ * instancias de hasta MaxMachines (<= 64) máquinas, MaxParts partes y
+ * MaxCells celdas, con todo el estado en std::array de tamaño fijo. Cada
+ * celda y cada parte es una máscara de 64 bits sobre las máquinas, así el
+ * costo de una parte es un AND y un POPCNT por celda hasta la primera que
+ * la usa; las celdas >= n_cells tienen máscara 0 y el ciclo de MaxCells
+ * iteraciones se desenrolla completo. Las máquinas fuera de rango van al
+ * índice MaxCells, que no se recorre (como en get_cost).
+ */
+template<unsigned int MaxMachines, unsigned int MaxParts, unsigned int MaxCells>
+class FixedKernel : public FixedKernelBase {
+public:
+	static const unsigned int PART_WORDS = (MaxParts+63)/64;
+	typedef std::array<uint64_t, MaxCells+1> CellMasks;
+
+	void reset(unsigned int n_machines, unsigned int n_parts,
+			unsigned int n_cells, unsigned int max_machines_cell,
+			const Adjacency &parts_machines);
+	long evaluate(const int *cell_vector) const;
+	long load(Solution *solution);
+	long swap_delta(unsigned int i, unsigned int j) const;
+	bool candidate(unsigned int machine) const;
+	long cost;
+private:
+	unsigned int cell_index(int k) const;
+	long penalty(const CellMasks &masks) const;
+	int part_cost(const CellMasks &masks, unsigned int part) const;
+	int part_owner_of(const CellMasks &masks, unsigned int part) const;
+	unsigned int n_machines;
+	unsigned int n_parts;
+	unsigned int n_cells;
+	unsigned int max_machines_cell;
+	std::array<uint64_t, MaxParts> part_machines;          // máquinas de cada parte
+	std::array<int, MaxParts> part_degree;
+	std::array<std::array<uint64_t, PART_WORDS>, MaxMachines> machine_parts;
+	std::array<unsigned int, MaxMachines> cells;           // celda de cada máquina
+	CellMasks cell_machines;                               // máquinas de cada celda
+	std::array<int, MaxParts> part_costs;
+	std::array<int, MaxParts> part_owner;                  // MaxCells si ninguna
+};
+
+typedef FixedKernel<16, 32, 4> FixedKernel16x32x4;
+typedef FixedKernel<32, 64, 8> FixedKernel32x64x8;
+typedef FixedKernel<64, 128, 16> FixedKernel64x128x16;
+
+// menor especialización donde cabe la instancia, FIXED_NONE si no hay
+int fixed_kernel_size(unsigned int n_machines, unsigned int n_parts,
+		unsigned int n_cells);
+FixedKernelBase *create_fixed_kernel(int size);
+
+template<unsigned int M, unsigned int P, unsigned int C>
+void FixedKernel<M,P,C>::reset(unsigned int n_machines, unsigned int n_parts,
+		unsigned int n_cells, unsigned int max_machines_cell,
+		const Adjacency &parts_machines) {
+
+	this->n_machines = n_machines;
+	this->n_parts = n_parts;
+	this->n_cells = n_cells;
+	this->max_machines_cell = max_machines_cell;
+	this->cost = -1;
+
+	part_machines.fill(0);
+	for(unsigned int i=0;i<M;i++)
+		machine_parts[i].fill(0);
+
+	for(unsigned int i=0;i<n_machines;i++){
+		for(const int *p=parts_machines.begin(i);p!=parts_machines.end(i);p++){
+			part_machines[*p] |= (uint64_t)1 << i;
+			machine_parts[i][*p >> 6] |= (uint64_t)1 << (*p & 63);
+		}
+	}
+
+	for(unsigned int j=0;j<P;j++)
+		part_degree[j] = popcount64(part_machines[j]);
+}
+
+template<unsigned int M, unsigned int P, unsigned int C>
+inline unsigned int FixedKernel<M,P,C>::cell_index(int k) const {
+	return (k < 0 || k >= (signed int)n_cells) ? C : k;
+}
+
+template<unsigned int M, unsigned int P, unsigned int C>
+inline long FixedKernel<M,P,C>::penalty(const CellMasks &masks) const {
+
+	long penalty = 0;
+	for(unsigned int k=0;k<C;k++){
+		int difference = popcount64(masks[k]) - max_machines_cell;
+		if(difference > 0)
+			penalty += (long)difference*n_machines*n_parts;
+	}
+	return penalty;
+}
+
+template<unsigned int M, unsigned int P, unsigned int C>
+inline int FixedKernel<M,P,C>::part_cost(const CellMasks &masks,
+		unsigned int part) const {
+
+	// máquinas de la parte fuera de la primera celda que la usa
+	uint64_t machines = part_machines[part];
+	for(unsigned int k=0;k<C;k++){
+		uint64_t in = masks[k] & machines;
+		if(in != 0)
+			return part_degree[part] - popcount64(in);
+	}
+	return 0;
+}
+
+template<unsigned int M, unsigned int P, unsigned int C>
+inline int FixedKernel<M,P,C>::part_owner_of(const CellMasks &masks,
+		unsigned int part) const {
+
+	for(unsigned int k=0;k<C;k++){
+		if((masks[k] & part_machines[part]) != 0)
+			return k;
+	}
+	return C;
+}
+
+template<unsigned int M, unsigned int P, unsigned int C>
+long FixedKernel<M,P,C>::evaluate(const int *cell_vector) const {
+
+	CellMasks masks;
+	masks.fill(0);
+	for(unsigned int i=0;i<n_machines;i++)
+		masks[cell_index(cell_vector[i])] |= (uint64_t)1 << i;
+
+	long cost = penalty(masks);
+	for(unsigned int j=0;j<n_parts;j++)
+		cost += part_cost(masks, j);
+	return cost;
+}
+
+template<unsigned int M, unsigned int P, unsigned int C>
+long FixedKernel<M,P,C>::load(Solution *solution) {
+
+	cell_machines.fill(0);
+	for(unsigned int i=0;i<n_machines;i++){
+		cells[i] = cell_index(solution->cell_vector[i]);
+		cell_machines[cells[i]] |= (uint64_t)1 << i;
+	}
+
+	cost = penalty(cell_machines);
+	for(unsigned int j=0;j<n_parts;j++){
+		part_costs[j] = part_cost(cell_machines, j);
+		part_owner[j] = part_owner_of(cell_machines, j);
+		cost += part_costs[j];
+	}
+	return cost;
+}
+
+template<unsigned int M, unsigned int P, unsigned int C>
+long FixedKernel<M,P,C>::swap_delta(unsigned int i, unsigned int j) const {
+
+	unsigned int cell_i = cells[i];
+	unsigned int cell_j = cells[j];
+	if(cell_i == cell_j)
+		return 0;
+
+	// las máquinas i y j cambian de máscara; el tamaño de las celdas no
+	CellMasks masks = cell_machines;
+	uint64_t swapped = ((uint64_t)1 << i) | ((uint64_t)1 << j);
+	masks[cell_i] ^= swapped;
+	masks[cell_j] ^= swapped;
+
+	// las partes que usan ambas máquinas no cambian de costo
+	long delta = 0;
+	for(unsigned int w=0;w<PART_WORDS;w++){
+		uint64_t changed = machine_parts[i][w] ^ machine_parts[j][w];
+		while(changed != 0){
+			unsigned int part = w*64 + __builtin_ctzll(changed);
+			changed &= changed-1;
+			delta += part_cost(masks, part) - part_costs[part];
+		}
+	}
+	return delta;
+}
+
+template<unsigned int M, unsigned int P, unsigned int C>
+bool FixedKernel<M,P,C>::candidate(unsigned int machine) const {
+
+	// máquina en una celda sobre max_machines_cell
+	unsigned int k = cells[machine];
+	if(k < C && popcount64(cell_machines[k]) > (signed int)max_machines_cell)
+		return true;
+
+	// máquina con algún elemento excepcional (parte de otra celda)
+	for(unsigned int w=0;w<PART_WORDS;w++){
+		uint64_t parts = machine_parts[machine][w];
+		while(parts != 0){
+			unsigned int part = w*64 + __builtin_ctzll(parts);
+			parts &= parts-1;
+			if(part_owner[part] != (signed int)k)
+				return true;
+		}
+	}
+	return false;
+}
+
+} /* namespace tabu */
+#endif /* FIXEDKERNEL_H_ */
@@ -0,0 +1,21 @@
+#ifndef HASH_H_
+#define HASH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace tabu {
+
+// FNV-1a de 64 bits; hash permite encadenar varios bloques
+inline uint64_t fnv1a_hash(const void *data, size_t size,
+		uint64_t hash = 0xcbf29ce484222325ULL) {
+	const unsigned char *p = (const unsigned char *)data;
+	for(size_t b=0;b<size;b++){
+		hash ^= p[b];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+} /* namespace tabu */
+#endif /* HASH_H_ */
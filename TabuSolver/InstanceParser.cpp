@@ -7,13 +7,24 @@
 
 #include "InstanceParser.h"
 #include <iostream>
+#include <sstream>
+#include <climits>
+#include <cstring>
 #include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace tabu {
 
 InstanceParser::InstanceParser() {
 	machines = 0;
 	parts = 0;
+	filename = NULL;
 }
 
 InstanceParser::~InstanceParser() {
@@ -21,30 +32,381 @@ InstanceParser::~InstanceParser() {
 
 Matrix *InstanceParser::parse_input(const char *filename) {
 
+	this->filename = filename;
+	error.clear();
+
+	int fd = open(filename, O_RDONLY);
+	if(fd < 0){
+		error = std::string(filename) + ": no se pudo abrir el archivo";
+		return NULL;
+	}
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size == 0){
+		close(fd);
+		error = std::string(filename) + ": archivo vacío o ilegible";
+		return NULL;
+	}
+
+	size_t size = st.st_size;
+	void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(data == MAP_FAILED){
+		error = std::string(filename) + ": no se pudo mapear el archivo";
+		return NULL;
+	}
+
+	// instancia binaria: el mapeo pasa a la Matrix
+	if(size >= sizeof(BinaryInstanceHeader) &&
+			memcmp(data, BINARY_INSTANCE_MAGIC, 8) == 0){
+		Matrix *mat = parse_binary(data, size);
+		if(mat == NULL)
+			munmap(data, size);
+		return mat;
+	}
+
+	madvise(data, size, MADV_SEQUENTIAL);
+
+	Matrix *mat = parse_buffer((const char *)data, size);
+
+	munmap(data, size);
+	return mat;
+}
+
+Matrix *InstanceParser::parse_binary(void *data, size_t size) {
+
+	const char *base = (const char *)data;
+	const BinaryInstanceHeader *h = (const BinaryInstanceHeader *)data;
+	std::string prefix = std::string(filename) + ": instancia binaria inválida: ";
+
+	if(h->byte_order != BINARY_INSTANCE_BYTE_ORDER){
+		error = prefix + "orden de bytes distinto al de esta máquina";
+		return NULL;
+	}
+	if(h->version != BINARY_INSTANCE_VERSION ||
+			h->header_size != sizeof(BinaryInstanceHeader)){
+		std::ostringstream msg;
+		msg << prefix << "versión " << h->version << " no soportada (se espera "
+				<< BINARY_INSTANCE_VERSION << ")";
+		error = msg.str();
+		return NULL;
+	}
+	if(h->file_size != size){
+		error = prefix + "archivo truncado";
+		return NULL;
+	}
+	if(h->rows <= 0 || h->cols <= 0 || h->rows > INT_MAX/h->cols ||
+			h->words != (h->cols+63)/64 ||
+			h->nnz > (uint64_t)h->rows*h->cols){
+		error = prefix + "dimensiones inválidas";
+		return NULL;
+	}
+
+	if(!check_section(size, h->bits_offset, (uint64_t)h->rows*h->words*8) ||
+			!check_csr(base, size, h->row_offsets_offset, h->row_indices_offset,
+					h->rows, h->cols, h->nnz) ||
+			!check_csr(base, size, h->col_offsets_offset, h->col_indices_offset,
+					h->cols, h->rows, h->nnz)){
+		error = prefix + error;
+		return NULL;
+	}
+
+	Matrix *mat = new Matrix(h->rows, h->cols,
+			(const uint64_t *)(base+h->bits_offset), data, size);
+	mat->index.view(h->rows, (const int *)(base+h->row_offsets_offset),
+			(const int *)(base+h->row_indices_offset));
+	mat->col_lists.view(h->cols, (const int *)(base+h->col_offsets_offset),
+			(const int *)(base+h->col_indices_offset));
+
+	this->parts = h->cols;
+	this->machines = h->rows;
+	return mat;
+}
+
+bool InstanceParser::check_section(size_t size, uint64_t offset, uint64_t bytes) {
+	if(offset % 64 != 0 || offset > size || bytes > size-offset){
+		error = "sección fuera del archivo";
+		return false;
+	}
+	return true;
+}
+
+bool InstanceParser::check_csr(const char *data, size_t size,
+		uint64_t offsets_at, uint64_t indices_at, int rows, int cols,
+		uint64_t nnz) {
+
+	if(!check_section(size, offsets_at, ((uint64_t)rows+1)*4) ||
+			!check_section(size, indices_at, nnz*4))
+		return false;
+
+	// recorrido completo: índices fuera de rango romperían a los solvers
+	const int32_t *offsets = (const int32_t *)(data+offsets_at);
+	const int32_t *indices = (const int32_t *)(data+indices_at);
+	if(offsets[0] != 0 || (uint64_t)offsets[rows] != nnz){
+		error = "listas de adyacencia inconsistentes";
+		return false;
+	}
+	for(int i=0;i<rows;i++){
+		if(offsets[i+1] < offsets[i]){
+			error = "listas de adyacencia inconsistentes";
+			return false;
+		}
+		for(int p=offsets[i];p<offsets[i+1];p++){
+			if(indices[p] < 0 || indices[p] >= cols ||
+					(p > offsets[i] && indices[p] <= indices[p-1])){
+				error = "índice de adyacencia fuera de rango o desordenado";
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// escribe las secciones alineadas a 64 bytes, ver BinaryInstanceHeader
+static uint64_t write_section(FILE *file, uint64_t at, const void *data,
+		uint64_t bytes) {
+	static const char zeros[64] = { 0 };
+	uint64_t start = (at+63) & ~(uint64_t)63;
+	fwrite(zeros, 1, start-at, file);
+	fwrite(data, 1, bytes, file);
+	return start;
+}
+
+bool InstanceParser::write_binary(Matrix *mat, const char *filename) {
+
+	const Adjacency &by_row = mat->row_index();
+	const Adjacency &by_col = mat->col_index();
+
+	BinaryInstanceHeader h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, BINARY_INSTANCE_MAGIC, 8);
+	h.version = BINARY_INSTANCE_VERSION;
+	h.byte_order = BINARY_INSTANCE_BYTE_ORDER;
+	h.header_size = sizeof(h);
+	h.rows = mat->rows;
+	h.cols = mat->cols;
+	h.words = mat->words;
+	h.nnz = by_row.offsets[mat->rows];
+
 	FILE *file;
-	if ((file = fopen(filename, "r")) == NULL)
-	        return NULL;
+	if((file = fopen(filename, "wb")) == NULL){
+		error = std::string(filename) + ": no se pudo crear el archivo";
+		return false;
+	}
+
+	// el encabezado se reescribe al final con los desplazamientos
+	uint64_t at = fwrite(&h, 1, sizeof(h), file);
+	uint64_t bytes = (uint64_t)mat->rows*mat->words*8;
+	h.bits_offset = write_section(file, at, mat->bits, bytes);
+	at = h.bits_offset + bytes;
+	h.row_offsets_offset = write_section(file, at, by_row.offsets, (mat->rows+1)*4);
+	at = h.row_offsets_offset + (mat->rows+1)*4;
+	h.row_indices_offset = write_section(file, at, by_row.indices, h.nnz*4);
+	at = h.row_indices_offset + h.nnz*4;
+	h.col_offsets_offset = write_section(file, at, by_col.offsets, (mat->cols+1)*4);
+	at = h.col_offsets_offset + (mat->cols+1)*4;
+	h.col_indices_offset = write_section(file, at, by_col.indices, h.nnz*4);
+	h.file_size = h.col_indices_offset + h.nnz*4;
 
-	int filas = 0;
-	int columnas = 0;
+	rewind(file);
+	fwrite(&h, 1, sizeof(h), file);
+
+	bool ok = !ferror(file);
+	if(fclose(file) != 0 || !ok){
+		error = std::string(filename) + ": error de escritura";
+		remove(filename);
+		return false;
+	}
+
+	return true;
+}
+
+Matrix *InstanceParser::parse_buffer(const char *data, size_t size) {
+
+	Scanner s;
+	s.p = data;
+	s.end = data+size;
+	s.line_start = data;
+	s.line = 1;
+
+	long filas = 0;
+	long columnas = 0;
+	if(!read_int(s, filas, "número de máquinas") ||
+			!read_int(s, columnas, "número de partes"))
+		return NULL;
+
+	if(filas <= 0 || columnas <= 0 || filas > INT_MAX/columnas){
+		fail(s, s.p, "dimensiones inválidas");
+		return NULL;
+	}
 
-	fscanf(file, "%i %i", &filas, &columnas);
 	Matrix *mat = new Matrix(filas,columnas);
+	mat->index.clear();
 
-	for(int i=0;i<filas;i++){
-		for(int j=0;j<columnas;j++){
-			int buffer = 0;
+	if(!parse_body(s, mat)){
+		delete mat;
+		return NULL;
+	}
 
-			fscanf(file, "%i", &buffer);
-			mat->getMatrix()[i][j] = buffer;
-		}
+	skip_space(s);
+	if(s.p != s.end){
+		fail(s, s.p, "datos sobrantes después de la matriz");
+		delete mat;
+		return NULL;
 	}
 
-	fclose(file);
+	mat->index.seal();
 
 	this->parts = columnas;
 	this->machines = filas;
 	return mat;
 }
 
+/*
+ * Cuerpo de la matriz: con SSE2 se clasifican 16 bytes a la vez; si el
+ * bloque sólo tiene '0', '1' y espacios, y ningún par de dígitos seguidos,
+ * cada dígito es una celda y basta recorrer la máscara de dígitos. Cualquier
+ * otro bloque (saltos de línea, tabs, errores) pasa por el camino escalar,
+ * que es el que reporta los errores.
+ */
+bool InstanceParser::parse_body(Scanner &s, Matrix *mat) {
+
+	const int cols = mat->cols;
+	const long total = (long)mat->rows*cols;
+	long read = 0;
+	int i = 0;
+	int j = 0;
+
+	while(read < total){
+
+#ifdef __SSE2__
+		if(s.end-s.p >= 16){
+			__m128i chunk = _mm_loadu_si128((const __m128i *)s.p);
+			unsigned int ones = _mm_movemask_epi8(
+					_mm_cmpeq_epi8(chunk, _mm_set1_epi8('1')));
+			unsigned int zeros = _mm_movemask_epi8(
+					_mm_cmpeq_epi8(chunk, _mm_set1_epi8('0')));
+			unsigned int spaces = _mm_movemask_epi8(
+					_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')));
+			unsigned int digits = ones | zeros;
+			bool adjacent = (digits & (digits << 1)) != 0;
+			int width = 16;
+
+			// un dígito en el último byte puede seguir en el bloque siguiente
+			if(digits & 0x8000){
+				digits &= 0x7FFF;
+				ones &= 0x7FFF;
+				width = 15;
+			}
+
+			if(!adjacent &&
+					(digits | spaces | (width == 15 ? 0x8000 : 0)) == 0xFFFF &&
+					__builtin_popcount(digits) <= total-read){
+				while(digits){
+					int b = __builtin_ctz(digits);
+					if(ones & (1u << b)){
+						mat->row(i)[j>>6] |= (uint64_t)1 << (j&63);
+						mat->index.add(j);
+					}
+					if(++j == cols){
+						j = 0;
+						i++;
+						mat->index.end_row();
+					}
+					read++;
+					digits &= digits-1;
+				}
+				s.p += width;
+				continue;
+			}
+		}
+#endif
+
+		skip_space(s);
+		if(s.p == s.end){
+			std::ostringstream msg;
+			msg << "fin de archivo: se esperaban " << total
+					<< " valores y se leyeron " << read;
+			fail(s, s.p, msg.str());
+			return false;
+		}
+
+		const char *start = s.p;
+		long value;
+		if(!read_int(s, value, "valor 0/1"))
+			return false;
+		if(value != 0 && value != 1){
+			std::ostringstream msg;
+			msg << "valor " << value << " en (" << i << "," << j
+					<< "), se esperaba 0 o 1";
+			fail(s, start, msg.str());
+			return false;
+		}
+
+		if(value){
+			mat->row(i)[j>>6] |= (uint64_t)1 << (j&63);
+			mat->index.add(j);
+		}
+		if(++j == cols){
+			j = 0;
+			i++;
+			mat->index.end_row();
+		}
+		read++;
+	}
+
+	return true;
+}
+
+bool InstanceParser::read_int(Scanner &s, long &value, const char *what) {
+
+	skip_space(s);
+	const char *start = s.p;
+	if(s.p == s.end || *s.p < '0' || *s.p > '9'){
+		std::string msg = std::string("se esperaba ") + what;
+		if(s.p != s.end)
+			msg += std::string(", se encontró '") + *s.p + "'";
+		fail(s, start, msg);
+		return false;
+	}
+
+	value = 0;
+	while(s.p != s.end && *s.p >= '0' && *s.p <= '9'){
+		if(value > (LONG_MAX-9)/10){
+			fail(s, start, std::string(what) + " demasiado grande");
+			return false;
+		}
+		value = value*10 + (*s.p - '0');
+		s.p++;
+	}
+
+	if(s.p != s.end && *s.p != ' ' && *s.p != '\t' && *s.p != '\r' &&
+			*s.p != '\n'){
+		fail(s, s.p, std::string("carácter inesperado '") + *s.p + "'");
+		return false;
+	}
+
+	return true;
+}
+
+void InstanceParser::skip_space(Scanner &s) {
+	while(s.p != s.end){
+		if(*s.p == '\n'){
+			s.line++;
+			s.line_start = s.p+1;
+		} else if(*s.p != ' ' && *s.p != '\t' && *s.p != '\r')
+			break;
+		s.p++;
+	}
+}
+
+void InstanceParser::fail(const Scanner &s, const char *at,
+		const std::string &message) {
+	std::ostringstream msg;
+	msg << filename << ":" << s.line << ":" << (at-s.line_start+1) << ": "
+			<< message;
+	error = msg.str();
+}
+
 } /* namespace tabu */
@@ -8,17 +8,84 @@
 #ifndef INSTANCEPARSER_H_
 #define INSTANCEPARSER_H_
 
+#include <string>
+#include <stdint.h>
 #include "Matrix.h"
 
 namespace tabu {
 
+/*
+ * Formato binario de instancia (version 1, en el orden de bytes de la
+ * máquina que lo escribió; byte_order lo verifica). Tras el encabezado,
+ * cada sección empieza en un múltiplo de 64 bytes:
+ *   bits         rows*words uint64_t, filas de la Matrix empaquetadas
+ *   row_offsets  rows+1 int32_t, CSR máquina -> partes
+ *   row_indices  nnz int32_t
+ *   col_offsets  cols+1 int32_t, CSR parte -> máquinas
+ *   col_indices  nnz int32_t
+ * Los desplazamientos son desde el inicio del archivo. Lo genera
+ * TabuConvert a partir del formato de texto.
+ */
+#define BINARY_INSTANCE_MAGIC "TABUINST"
+#define BINARY_INSTANCE_VERSION 1
+#define BINARY_INSTANCE_BYTE_ORDER 0x01020304
+
+typedef struct binary_instance_header {
+
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t header_size;
+	int32_t rows;
+	int32_t cols;
+	int32_t words;
+	uint64_t nnz;
+	uint64_t bits_offset;
+	uint64_t row_offsets_offset;
+	uint64_t row_indices_offset;
+	uint64_t col_offsets_offset;
+	uint64_t col_indices_offset;
+	uint64_t file_size;
+} BinaryInstanceHeader;
+
+/*
+ * Lee una instancia "filas columnas" seguida de filas*columnas valores 0/1.
+ * El archivo se mapea en memoria y se recorre una sola vez, llenando los
+ * bits de la Matrix y su row_index() al mismo tiempo. Si la entrada está
+ * mal formada parse_input retorna NULL y deja en error el mensaje con
+ * archivo, línea y columna.
+ *
+ * Una instancia en formato binario se reconoce por su magic y se usa sin
+ * copiar: la Matrix y sus row_index()/col_index() apuntan al archivo
+ * mapeado, que los procesos comparten desde el page cache.
+ */
 class InstanceParser {
 public:
 	InstanceParser();
 	virtual ~InstanceParser();
 	Matrix *parse_input(const char *filename);
+	bool write_binary(Matrix *mat, const char *filename);
 	int machines;
 	int parts;
+	std::string error;
+
+private:
+	struct Scanner {
+		const char *p;
+		const char *end;
+		const char *line_start;
+		int line;
+	};
+	const char *filename;
+	Matrix *parse_buffer(const char *data, size_t size);
+	Matrix *parse_binary(void *data, size_t size);
+	bool check_section(size_t size, uint64_t offset, uint64_t bytes);
+	bool check_csr(const char *data, size_t size, uint64_t offsets_at,
+			uint64_t indices_at, int rows, int cols, uint64_t nnz);
+	bool parse_body(Scanner &s, Matrix *mat);
+	bool read_int(Scanner &s, long &value, const char *what);
+	void skip_space(Scanner &s);
+	void fail(const Scanner &s, const char *at, const std::string &message);
 };
 
 } /* namespace tabu */
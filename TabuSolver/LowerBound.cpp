@@ -0,0 +1,62 @@
+#include "LowerBound.h"
+#include <vector>
+#include <algorithm>
+
+namespace tabu {
+
+static int find_root(std::vector<int> &parent, int x) {
+	while(parent[x] != x){
+		parent[x] = parent[parent[x]];
+		x = parent[x];
+	}
+	return x;
+}
+
+long exceptional_lower_bound(const Adjacency &machines_of,
+		unsigned int n_machines, unsigned int n_parts, unsigned int n_cells,
+		unsigned int max_machines_cell) {
+
+	if(max_machines_cell == 0 ||
+			(unsigned long)n_cells*max_machines_cell < n_machines)
+		return 0;
+
+	// componentes conexas de máquinas: union-find sobre las partes
+	std::vector<int> parent(n_machines);
+	for(unsigned int i=0;i<n_machines;i++)
+		parent[i] = i;
+
+	for(unsigned int j=0;j<n_parts;j++){
+		const int *i = machines_of.begin(j);
+		if(i == machines_of.end(j))
+			continue;
+		int root = find_root(parent, *i);
+		for(i++;i!=machines_of.end(j);i++){
+			int r = find_root(parent, *i);
+			if(r != root)
+				parent[r] = root;
+		}
+	}
+
+	std::vector<long> machines(n_machines, 0); // por raíz
+	std::vector<long> overflow(n_machines, 0); // sum max(0, m_j - max)
+	for(unsigned int i=0;i<n_machines;i++)
+		machines[find_root(parent, i)]++;
+
+	for(unsigned int j=0;j<n_parts;j++){
+		int m = machines_of.count(j);
+		if(m > (signed int)max_machines_cell)
+			overflow[find_root(parent, *machines_of.begin(j))] += m - max_machines_cell;
+	}
+
+	long bound = 0;
+	for(unsigned int i=0;i<n_machines;i++){
+		if(parent[i] != (signed int)i)
+			continue;
+		long cells = (machines[i] + max_machines_cell - 1) / max_machines_cell;
+		bound += std::max(overflow[i], cells - 1);
+	}
+
+	return bound;
+}
+
+} /* namespace tabu */
@@ -0,0 +1,28 @@
+#ifndef LOWERBOUND_H_
+#define LOWERBOUND_H_
+
+#include "Matrix.h"
+
+namespace tabu {
+
+/*
+ * Cota inferior del costo (elementos excepcionales más penalización) de
+ * cualquier solución con n_cells celdas de a lo más max_machines_cell
+ * máquinas; machines_of es el índice parte -> máquinas (col_index()).
+ *
+ * Con m_j máquinas la parte j deja al menos m_j - max_machines_cell fuera
+ * de su celda. Además, si una componente conexa de máquinas (unidas por
+ * partes comunes) tiene s > max_machines_cell máquinas, queda repartida
+ * en p >= ceil(s/max_machines_cell) celdas, y para conectarlas las partes
+ * deben sumar al menos p-1 elementos excepcionales. La cota es la suma,
+ * por componente, del mayor de ambos argumentos. Una solución infactible
+ * cuesta más que cualquier cantidad de elementos excepcionales, así que
+ * la cota vale también para ellas. Si las máquinas no caben en las celdas
+ * retorna 0.
+ */
+long exceptional_lower_bound(const Adjacency &machines_of,
+		unsigned int n_machines, unsigned int n_parts, unsigned int n_cells,
+		unsigned int max_machines_cell);
+
+} /* namespace tabu */
+#endif /* LOWERBOUND_H_ */
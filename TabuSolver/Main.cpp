@@ -9,34 +9,63 @@
 #include <cstdlib>
 #include <iostream>
 #include <unistd.h>
+#include <getopt.h>
 #include "InstanceParser.h"
 #include "Solution.h"
 #include "SolutionBuilder.h"
 #include "Solver.h"
 #include "ParallelSolver.h"
+#include "ThreadedSolver.h"
+#include "Portfolio.h"
+#include "Report.h"
+#include "Batch.h"
 #include "Matrix.h"
 
 int main(int argc, char* argv[]) {
 
-	int iterations;
-	int diversification_param;
+	int iterations = 1000;
+	int diversification_param = 2;
 	int machines;
 	int parts;
-	int cells;
-	int max_machines_cell;
-	int tabu_turns;
+	int cells = 2;
+	int max_machines_cell = 8;
+	int tabu_turns = 100;
 	std::string filename = "";
 	std::string file_out = "";
 	opterr = 0;
 	int c;
 	bool parallel_cost = false;
-
-	if(argc < 13){
-		std::cout << "argumentos : -i <numero iteraciones> -d <param diversificacion> -c <celdas> -m <máquinas max por celda> -t <turnos tabu> -f <archivo entrada>\n";
-		return EXIT_SUCCESS;
-	}
-
-	while ((c = getopt(argc, argv, "i:d:m:p:c:M:t:f:PO:")) != -1){
+	int threads = -1;
+	int runs = 0;
+	unsigned int seed = time(NULL);
+	bool seeded = false;
+	unsigned int candidate_period = 0;
+	int verbosity = tabu::TRACE_SOLUTIONS;
+	std::string trace_file = "";
+	std::string report_file = "";
+	double time_budget = 0;
+	unsigned int stagnation_limit = 0;
+	int target_cost = -1;
+	std::string batch_file = "";
+	std::string checkpoint_file = "";
+	unsigned int checkpoint_period = 1000;
+	bool resume = false;
+	std::string cl_cache_dir = "";
+	unsigned int diversification_candidates = 1;
+	unsigned int migration_period = 0;
+	int migration_topology = tabu::MIGRATION_RING;
+	unsigned int elite_size = 0;
+	unsigned int relink_period = 0;
+
+	// sólo opciones largas; el resto son las cortas de siempre
+	static struct option long_options[] = {
+		{"resume", no_argument, NULL, 'r'},
+		{"topology", required_argument, NULL, 'y'},
+		{NULL, 0, NULL, 0}
+	};
+
+	while ((c = getopt_long(argc, argv, "i:d:m:p:c:M:t:f:PO:T:R:S:L:v:l:J:B:N:G:b:C:K:D:W:I:E:X:",
+			long_options, NULL)) != -1){
 		switch (c) {
 		case 'i':
 
@@ -70,8 +99,100 @@ int main(int argc, char* argv[]) {
 
 			parallel_cost = true;
 			break;
+		case 'T':
+
+			threads = atoi(optarg);
+			break;
+		case 'R':
+
+			runs = atoi(optarg);
+			break;
+		case 'S':
+
+			seed = strtoul(optarg, NULL, 10);
+			seeded = true;
+			break;
+		case 'L':
+
+			candidate_period = strtoul(optarg, NULL, 10);
+			break;
+		case 'v':
+
+			verbosity = atoi(optarg);
+			break;
+		case 'l':
+
+			trace_file.assign(optarg, strlen(optarg));
+			break;
+		case 'J':
+
+			report_file.assign(optarg, strlen(optarg));
+			break;
+		case 'B':
+
+			time_budget = atof(optarg);
+			break;
+		case 'N':
+
+			stagnation_limit = strtoul(optarg, NULL, 10);
+			break;
+		case 'G':
+
+			target_cost = atoi(optarg);
+			break;
+		case 'b':
+
+			batch_file.assign(optarg, strlen(optarg));
+			break;
+		case 'C':
+
+			checkpoint_file.assign(optarg, strlen(optarg));
+			break;
+		case 'K':
+
+			checkpoint_period = strtoul(optarg, NULL, 10);
+			break;
+		case 'r':
+
+			resume = true;
+			break;
+		case 'D':
+
+			cl_cache_dir.assign(optarg, strlen(optarg));
+			break;
+		case 'W':
+
+			diversification_candidates = strtoul(optarg, NULL, 10);
+			break;
+		case 'I':
+
+			migration_period = strtoul(optarg, NULL, 10);
+			break;
+		case 'E':
+
+			elite_size = strtoul(optarg, NULL, 10);
+			break;
+		case 'X':
+
+			relink_period = strtoul(optarg, NULL, 10);
+			break;
+		case 'y':
+
+			if(strcmp(optarg, "ring") == 0)
+				migration_topology = tabu::MIGRATION_RING;
+			else if(strcmp(optarg, "random") == 0)
+				migration_topology = tabu::MIGRATION_RANDOM;
+			else {
+				fprintf(stderr, "--topology debe ser ring o random\n");
+				return 1;
+			}
+			break;
 		case '?':
-			if (optopt == 'O')
+			if (optopt == 'O' || optopt == 'T' || optopt == 'R' || optopt == 'S' || optopt == 'L' ||
+					optopt == 'v' || optopt == 'l' || optopt == 'J' || optopt == 'B' ||
+					optopt == 'N' || optopt == 'G' || optopt == 'b' ||
+					optopt == 'C' || optopt == 'K' || optopt == 'D' || optopt == 'W' || optopt == 'I' ||
+					optopt == 'E' || optopt == 'X')
 				fprintf(stderr, "Option -%c requires an argument.\n", optopt);
 			else if (isprint(optopt))
 				fprintf(stderr, "Unknown option `-%c'.\n", optopt);
@@ -85,8 +206,65 @@ int main(int argc, char* argv[]) {
 		}
 	}
 
+	// path relinking sin -E: pool de 10 élites
+	if(relink_period > 0 && elite_size == 0)
+		elite_size = 10;
+
+	if(batch_file.empty() && argc < 13){
+		std::cout << "argumentos : -i <numero iteraciones> -d <param diversificacion> -c <celdas> -m <máquinas max por celda> -t <turnos tabu> -f <archivo entrada> [-P [-D <caché de binarios OpenCL>] | -T <hilos, 0 = todos>] [-R <corridas en paralelo> [-I <período de migración> [--topology ring|random]]] [-S <semilla>] [-L <periodo lista de candidatos>] [-W <perturbaciones candidatas>] [-E <élites>] [-X <iteraciones sin mejora entre path relinking>] [-v <verbosidad 0-3>] [-l <archivo traza>] [-J <reporte json>] [-B <segundos>] [-N <iteraciones sin mejora>] [-G <costo objetivo>] [-C <checkpoint> [-K <período>] [--resume]]\n"
+				"       -b <manifiesto> [-T <hilos, 0 = todos>] [opciones por omisión]\n";
+		return EXIT_SUCCESS;
+	}
+
+	if(!batch_file.empty()){
+		// -T es el número de trabajos simultáneos; cada línea elige su backend
+		tabu::BatchJob defaults;
+		defaults.backend = parallel_cost ? "opencl" : "serial";
+		defaults.iterations = iterations;
+		defaults.diversification_param = diversification_param;
+		defaults.cells = cells;
+		defaults.max_machines_cell = max_machines_cell;
+		defaults.tabu_turns = tabu_turns;
+		defaults.seed = seed;
+		defaults.threads = 0;
+		defaults.candidate_list_period = candidate_period;
+		defaults.time_budget = time_budget;
+		defaults.stagnation_limit = stagnation_limit;
+		defaults.target_cost = target_cost;
+		defaults.diversification_candidates = diversification_candidates;
+		defaults.elite_size = elite_size;
+		defaults.relink_period = relink_period;
+
+		tabu::Batch batch(defaults, threads < 0 ? 0 : threads);
+		batch.cl_cache_dir = cl_cache_dir;
+		if(!batch.load(batch_file.c_str())){
+			fprintf(stderr, "%s\n", batch.error.c_str());
+			return 1;
+		}
+		batch.run(stdout);
+		return EXIT_SUCCESS;
+	}
+
+	if(resume && checkpoint_file.empty()){
+		fprintf(stderr, "--resume requiere -C <checkpoint>\n");
+		return 1;
+	}
+	if(!checkpoint_file.empty() && runs > 0){
+		fprintf(stderr, "-C no se admite con -R\n");
+		return 1;
+	}
+	if(migration_period > 0 && runs == 0){
+		fprintf(stderr, "-I requiere -R <islas>\n");
+		return 1;
+	}
+
 	tabu::InstanceParser *parser = new tabu::InstanceParser();
 	tabu::Matrix *mat = parser->parse_input(filename.c_str());
+	if(mat == NULL){
+		fprintf(stderr, "%s\n", parser->error.c_str());
+		delete parser;
+		return 1;
+	}
 	machines = parser->machines;
 	parts = parser->parts;
 
@@ -103,21 +281,76 @@ int main(int argc, char* argv[]) {
 
 	tabu::Solution *sol = NULL;
 	tabu::Solver *solver = NULL;
+	tabu::Portfolio *portfolio = NULL;
 
-	if(parallel_cost) {
-		solver = new tabu::ParallelSolver(iterations, diversification_param,
-				machines, parts, cells, max_machines_cell, mat,
-				tabu_turns);
+	// opciones comunes a los tres backends; cada rama fija sólo las propias
+	auto configure = [&](tabu::Solver *solver) {
 		solver->file_out = file_out;
-		sol = solver->solve();
+		solver->verbosity = verbosity;
+		solver->trace_file = trace_file;
+		solver->time_budget = time_budget;
+		solver->stagnation_limit = stagnation_limit;
+		solver->target_cost = target_cost;
+		solver->candidate_list_period = candidate_period;
+		solver->diversification_candidates = diversification_candidates;
+		solver->elite_size = elite_size;
+		solver->relink_period = relink_period;
+		solver->checkpoint_file = checkpoint_file;
+		solver->checkpoint_period = checkpoint_period;
+		solver->resume = resume;
+		if(seeded)
+			solver->seed = seed;
+	};
+
+	if(runs > 0) {
+		// -T fija los hilos del portafolio (cada corrida es secuencial)
+		portfolio = new tabu::Portfolio(runs, threads < 0 ? 0 : threads, seed,
+				iterations, diversification_param, machines, parts, cells,
+				max_machines_cell, mat, tabu_turns);
+		portfolio->candidate_list_period = candidate_period;
+		portfolio->time_budget = time_budget;
+		portfolio->stagnation_limit = stagnation_limit;
+		portfolio->target_cost = target_cost;
+		portfolio->diversification_candidates = diversification_candidates;
+		portfolio->migration_period = migration_period;
+		portfolio->migration_topology = migration_topology;
+		portfolio->elite_size = elite_size;
+		portfolio->relink_period = relink_period;
+		sol = portfolio->solve();
+		solver = portfolio->best_solver;
+		portfolio->print_stats();
 	} else {
-		solver = new tabu::Solver(iterations, diversification_param,
-				machines, parts, cells, max_machines_cell, mat,
-				tabu_turns);
-		solver->file_out = file_out;
+		if(parallel_cost) {
+			tabu::ParallelSolver *parallel = new tabu::ParallelSolver(iterations,
+					diversification_param, machines, parts, cells, max_machines_cell,
+					mat, tabu_turns);
+			parallel->cl_cache_dir = cl_cache_dir;
+			solver = parallel;
+		} else if(threads >= 0) {
+			solver = new tabu::ThreadedSolver(iterations, diversification_param,
+					machines, parts, cells, max_machines_cell, mat,
+					tabu_turns, threads);
+		} else {
+			solver = new tabu::Solver(iterations, diversification_param,
+					machines, parts, cells, max_machines_cell, mat,
+					tabu_turns);
+		}
+		configure(solver);
 		sol = solver->solve();
 	}
 
+	if(sol == NULL)
+		return 1;
+
+	if(!report_file.empty()){
+		const char *backend = portfolio != NULL ? "portfolio" :
+				parallel_cost ? "opencl" : threads >= 0 ? "threaded" : "serial";
+		std::vector<tabu::Solver *> report_runs(1, solver);
+		if(!tabu::write_json_report(report_file.c_str(), filename, backend,
+				portfolio != NULL ? portfolio->runs() : report_runs))
+			fprintf(stderr, "%s: no se pudo escribir el reporte\n", report_file.c_str());
+	}
+
 
 // ----------------------resultados globales -------------------------------------------
 
@@ -170,7 +403,7 @@ int main(int argc, char* argv[]) {
 			if (col == parts)
 				break;
 
-			if (solver->incidence_matrix->getMatrix()[rows[i]][j] == 1) {
+			if (solver->incidence_matrix->get(rows[i],j) == 1) {
 				columns[col] = j;
 				col++;
 				selected.push_back(j);
@@ -193,7 +426,7 @@ int main(int argc, char* argv[]) {
 			std::cout << " ";
 
 		for (int j = 0; j < parts; j++) {
-			int item = solver->incidence_matrix->getMatrix()[i][j];
+			int item = solver->incidence_matrix->get(i,j);
 			if (item == 1)
 				std::cout << item << " ";
 			else
@@ -218,7 +451,7 @@ int main(int argc, char* argv[]) {
 
 		for (int j = 0; j < parts; j++) {
 			int item =
-					solver->incidence_matrix->getMatrix()[rows[i]][columns[j]];
+					solver->incidence_matrix->get(rows[i],columns[j]);
 			if (item == 1)
 				std::cout << item << " ";
 			else
@@ -228,7 +461,11 @@ int main(int argc, char* argv[]) {
 	}
 
 	delete[] rows;
-	delete solver;
+	if(portfolio != NULL)
+		delete portfolio;
+	else
+		delete solver;
+	delete mat;
 
 	return EXIT_SUCCESS;
 }
@@ -6,25 +6,132 @@
  */
 
 #include "Matrix.h"
+#include <sys/mman.h>
 
 namespace tabu {
 
+Adjacency::Adjacency() {
+	rows = 0;
+	offsets = NULL;
+	indices = NULL;
+}
+
+void Adjacency::clear() {
+	rows = 0;
+	own_offsets.assign(1, 0);
+	own_indices.clear();
+	offsets = NULL;
+	indices = NULL;
+}
+
+void Adjacency::add(int index) {
+	own_indices.push_back(index);
+}
+
+void Adjacency::end_row() {
+	own_offsets.push_back(own_indices.size());
+	rows++;
+}
+
+void Adjacency::seal() {
+	offsets = &own_offsets[0];
+	indices = own_indices.empty() ? NULL : &own_indices[0];
+}
+
+void Adjacency::adopt(int rows, std::vector<int> &offsets,
+		std::vector<int> &indices) {
+	this->rows = rows;
+	own_offsets.swap(offsets);
+	own_indices.swap(indices);
+	seal();
+}
+
+void Adjacency::view(int rows, const int *offsets, const int *indices) {
+	own_offsets.clear();
+	own_indices.clear();
+	this->rows = rows;
+	this->offsets = offsets;
+	this->indices = indices;
+}
+
 Matrix::Matrix(const int _rows, const int _cols) : rows(_rows), cols(_cols)
 {
-	std::vector<std::vector<int> > storage(_rows,std::vector<int>(_cols,0));
-	this->storage = storage;
+	this->words = (_cols+63)/64;
+	this->storage.assign(_rows*words, 0);
+	this->bits = storage.empty() ? NULL : &storage[0];
+	this->mapping = NULL;
+	this->mapping_size = 0;
 }
 
+Matrix::Matrix(const int _rows, const int _cols, const uint64_t *bits,
+		void *mapping, size_t mapping_size) : rows(_rows), cols(_cols)
+{
+	this->words = (_cols+63)/64;
+	this->bits = bits;
+	this->mapping = mapping;
+	this->mapping_size = mapping_size;
+}
 
 Matrix::~Matrix() {
+	if(mapping != NULL)
+		munmap(mapping, mapping_size);
 }
 
-std::vector<int> &Matrix::operator [](int x) {
-	return this->storage[x];
+void Matrix::set(int i, int j, int value) {
+	uint64_t bit = (uint64_t)1 << (j&63);
+	if(value)
+		storage[i*words+(j>>6)] |= bit;
+	else
+		storage[i*words+(j>>6)] &= ~bit;
 }
 
-std::vector<std::vector<int> >& Matrix::getMatrix() {
-	return storage;
+const Adjacency &Matrix::row_index() {
+
+	// precómputo (una vez) de las columnas de cada fila, compartido en
+	// sólo lectura por todos los solvers de la matriz
+	if(index.size() == rows && index.offsets != NULL)
+		return index;
+
+	index.clear();
+	for(int i=0;i<rows;i++){
+		const uint64_t *r = bits + i*words;
+		for(int w=0;w<words;w++){
+			uint64_t word = r[w];
+			while(word){
+				index.add((w<<6) + __builtin_ctzll(word));
+				word &= word-1;
+			}
+		}
+		index.end_row();
+	}
+	index.seal();
+
+	return index;
+}
+
+const Adjacency &Matrix::col_index() {
+
+	if(col_lists.size() == cols && col_lists.offsets != NULL)
+		return col_lists;
+
+	// recorrido de row_index por columnas: cada lista queda ordenada por fila
+	const Adjacency &by_row = row_index();
+	std::vector<int> offsets(cols+1, 0);
+	for(int i=0;i<rows;i++)
+		for(const int *j=by_row.begin(i);j!=by_row.end(i);j++)
+			offsets[*j+1]++;
+	for(int j=0;j<cols;j++)
+		offsets[j+1] += offsets[j];
+
+	std::vector<int> lists(offsets[cols]);
+	std::vector<int> next(offsets.begin(), offsets.end()-1);
+	for(int i=0;i<rows;i++)
+		for(const int *j=by_row.begin(i);j!=by_row.end(i);j++)
+			lists[next[*j]++] = i;
+
+	col_lists.adopt(cols, offsets, lists);
+
+	return col_lists;
 }
 
 } /* namespace tabu */
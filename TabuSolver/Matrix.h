@@ -10,19 +10,104 @@
 
 #include <iostream>
 #include <vector>
+#include <stddef.h>
+#include <stdint.h>
 
 namespace tabu {
 
+// número de bits en 1 de una palabra (POPCNT por hardware con -mpopcnt)
+inline int popcount64(uint64_t word) {
+	return __builtin_popcountll(word);
+}
+
+/*
+ * Listas de adyacencia en formato CSR: los índices de la fila i son
+ * indices[offsets[i]] ... indices[offsets[i+1]-1], en orden ascendente.
+ * Los arreglos son propios (add/end_row/seal o adopt) o apuntan a memoria
+ * externa, como una instancia binaria mapeada (view).
+ */
+class Adjacency {
+public:
+	Adjacency();
+	void clear();
+	void add(int index);
+	void end_row();
+	void seal();
+	void adopt(int rows, std::vector<int> &offsets, std::vector<int> &indices);
+	void view(int rows, const int *offsets, const int *indices);
+	int size() const;
+	int count(int i) const;
+	const int *begin(int i) const;
+	const int *end(int i) const;
+	const int *offsets;
+	const int *indices;
+private:
+	Adjacency(const Adjacency &);
+	Adjacency &operator=(const Adjacency &);
+	int rows;
+	std::vector<int> own_offsets;
+	std::vector<int> own_indices;
+};
+
+inline int Adjacency::size() const {
+	return rows;
+}
+
+inline int Adjacency::count(int i) const {
+	return offsets[i+1] - offsets[i];
+}
+
+inline const int *Adjacency::begin(int i) const {
+	return indices + offsets[i];
+}
+
+inline const int *Adjacency::end(int i) const {
+	return indices + offsets[i+1];
+}
+
+/*
+ * Matriz de incidencia 0/1 empaquetada en bits: cada fila ocupa
+ * words palabras de 64 bits, el bit j%64 de la palabra j/64 es la columna j.
+ * Las palabras están en storage, o en una instancia binaria mapeada en
+ * memoria (sólo lectura, la Matrix libera el mapeo al destruirse). Sólo
+ * InstanceParser escribe las filas, y sólo en una Matrix propia (storage).
+ */
 class Matrix {
 public:
 	Matrix(const int _rows, const int _cols);
+	Matrix(const int _rows, const int _cols, const uint64_t *bits,
+			void *mapping, size_t mapping_size);
 	virtual ~Matrix();
-	std::vector<int>& operator [] (int x);
-	std::vector<std::vector<int> > &getMatrix();
-	std::vector<std::vector<int> > storage;
+	int get(int i, int j) const;
+	const uint64_t *row(int i) const;
+	const Adjacency &row_index();
+	const Adjacency &col_index();
+	std::vector<uint64_t> storage;
+	const uint64_t *bits;
+	Adjacency index;     // columnas en 1 de cada fila
+	Adjacency col_lists; // filas en 1 de cada columna
 	int rows;
 	int cols;
+	int words;
+private:
+	friend class InstanceParser;
+	void set(int i, int j, int value);
+	uint64_t *row(int i);
+	void *mapping;
+	size_t mapping_size;
 };
 
+inline int Matrix::get(int i, int j) const {
+	return (bits[i*words+(j>>6)] >> (j&63)) & 1;
+}
+
+inline uint64_t *Matrix::row(int i) {
+	return &storage[i*words];
+}
+
+inline const uint64_t *Matrix::row(int i) const {
+	return &bits[i*words];
+}
+
 } /* namespace tabu */
 #endif /* MATRIX_H_ */
@@ -0,0 +1,79 @@
+#include "Migration.h"
+#include <cstdlib>
+
+namespace tabu {
+
+Migration::Migration(unsigned int n_islands, unsigned int n_machines,
+		int topology, unsigned int seed) :
+		slots(new Slot[n_islands]), done(false) {
+
+	this->n_islands = n_islands;
+	this->n_machines = n_machines;
+	this->topology = topology;
+
+	for(unsigned int r=0;r<n_islands;r++){
+		slots[r].version.store(0, std::memory_order_relaxed);
+		slots[r].cost.store(-1, std::memory_order_relaxed);
+		slots[r].cells.reset(new std::atomic<int>[n_machines]);
+		rand_states.push_back(seed + r);
+	}
+}
+
+Migration::~Migration() {
+}
+
+void Migration::publish(unsigned int island, const int *cells, long cost) {
+
+	Slot &slot = slots[island];
+	unsigned long version = slot.version.load(std::memory_order_relaxed);
+
+	slot.version.store(version+1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	for(unsigned int i=0;i<n_machines;i++)
+		slot.cells[i].store(cells[i], std::memory_order_relaxed);
+	slot.cost.store(cost, std::memory_order_relaxed);
+
+	slot.version.store(version+2, std::memory_order_release);
+}
+
+unsigned int Migration::source(unsigned int island) {
+
+	if(topology == MIGRATION_RING || n_islands < 2)
+		return (island + n_islands - 1) % n_islands;
+
+	unsigned int offset = 1 + rand_r(&rand_states[island]) % (n_islands-1);
+	return (island + offset) % n_islands;
+}
+
+bool Migration::receive(unsigned int island, long better_than, int *cells,
+		long &cost) {
+
+	Slot &slot = slots[source(island)];
+
+	// nada publicado todavía o escritura en curso
+	unsigned long version = slot.version.load(std::memory_order_acquire);
+	if(version == 0 || (version & 1) != 0)
+		return false;
+
+	cost = slot.cost.load(std::memory_order_relaxed);
+	if(cost >= better_than)
+		return false;
+
+	for(unsigned int i=0;i<n_machines;i++)
+		cells[i] = slot.cells[i].load(std::memory_order_relaxed);
+
+	// la copia sólo vale si nadie publicó mientras tanto
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot.version.load(std::memory_order_relaxed) == version;
+}
+
+void Migration::finish() {
+	done.store(true, std::memory_order_release);
+}
+
+bool Migration::finished() const {
+	return done.load(std::memory_order_acquire);
+}
+
+} /* namespace tabu */
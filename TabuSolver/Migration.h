@@ -0,0 +1,49 @@
+#ifndef MIGRATION_H_
+#define MIGRATION_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace tabu {
+
+enum MigrationTopology {
+	MIGRATION_RING,   // la isla r recibe de r-1
+	MIGRATION_RANDOM  // cada vez de una isla al azar distinta de sí misma
+};
+
+/*
+ * Migración de élites entre las islas de un Portfolio. Cada isla tiene un
+ * slot con la mejor solución que publicó, protegido por un seqlock: sólo
+ * la isla dueña escribe (version impar mientras copia) y las demás leen sin
+ * tomar locks. Si una lectura se cruza con una escritura se descarta y la
+ * isla sigue con su diversificación normal, así ninguna espera a otra.
+ * finish() avisa a todas que una isla llegó al óptimo o al objetivo. La
+ * isla r elige vecinas (--topology random) con la semilla seed+r.
+ */
+class Migration {
+public:
+	Migration(unsigned int n_islands, unsigned int n_machines, int topology,
+			unsigned int seed);
+	virtual ~Migration();
+	void publish(unsigned int island, const int *cells, long cost);
+	bool receive(unsigned int island, long better_than, int *cells, long &cost);
+	void finish();
+	bool finished() const;
+	int topology;
+private:
+	typedef struct slot {
+		std::atomic<unsigned long> version; // 0: nada publicado
+		std::atomic<long> cost;
+		std::unique_ptr<std::atomic<int>[]> cells;
+	} Slot;
+	unsigned int source(unsigned int island);
+	unsigned int n_islands;
+	unsigned int n_machines;
+	std::unique_ptr<Slot[]> slots;
+	std::vector<unsigned int> rand_states; // uno por isla, sólo lo usa su hilo
+	std::atomic<bool> done;
+};
+
+} /* namespace tabu */
+#endif /* MIGRATION_H_ */
@@ -6,6 +6,7 @@
  */
 
 #include "ParallelSolver.h"
+#include "Hash.h"
 
 namespace tabu {
 
@@ -19,16 +20,23 @@ ParallelSolver::ParallelSolver(unsigned int max_iterations,
 
 	out_cost = NULL;
 	params = NULL;
-	gsol = NULL;
 	min_i = 0;
 	min_cost = UINT_MAX;
+	cost_local_size = 1;
+	shared_program = NULL;
+	own_program = NULL;
+	cl_ready = false;
+	buf_machines = 0;
+	buf_parts = 0;
+	buf_nnz = 0;
+	params = new ClParams();
 
 }
 
 ParallelSolver::~ParallelSolver() {
 
 	delete params;
-//	delete[] gsol;
+	delete own_program;
 //	delete[] out_cost;
 }
 
@@ -50,30 +58,92 @@ void print_vector(std::vector<std::vector<int> > vector){
 	std::cout << std::endl;
 }
 
-StaticMatrix* ParallelSolver::matrix_to_StaticMatrix(Matrix *mat) {
+// opciones de compilación del kernel, parte de la llave del caché
+static const char *kernel_build_options = "";
 
-	StaticMatrix *smat = new StaticMatrix();
+ClProgram::ClProgram() {
+	built = false;
+}
+
+std::string ClProgram::cache_key(const char *source, size_t size) {
 
-	int rows = mat->rows;
-	int cols = mat->cols;
+	char hash[32];
+	snprintf(hash, sizeof(hash), "%016llx",
+			(unsigned long long)fnv1a_hash(source, size));
+
+	std::string key = std::string("source ") + hash;
+	for(unsigned int d=0;d<devices.size();d++){
+		key += "\ndevice ";
+		key += devices[d].getInfo<CL_DEVICE_NAME>().c_str();
+		key += "\ndriver ";
+		key += devices[d].getInfo<CL_DRIVER_VERSION>().c_str();
+	}
+	key += "\noptions ";
+	key += kernel_build_options;
+	return key;
+}
 
-	int *storage = new cl_int[rows*cols];
-	smat->rows = rows;
-	smat->cols = cols;
+bool ClProgram::load_binaries(const std::string &key) {
 
-	memset(storage,0,sizeof(cl_int)*rows*cols);
+	ProgramBinaries binaries;
+	if(!read_program_cache(program_cache_path(cache_dir, key), key,
+			devices.size(), binaries))
+		return false;
 
-	for(int i=0;i<(signed int)mat->rows;i++){
-		std::copy(mat->storage[i].begin(), mat->storage[i].begin()+mat->storage[i].size(), storage+(i*cols));
+	std::vector<cl_device_id> ids;
+	std::vector<size_t> sizes;
+	std::vector<const unsigned char *> data;
+	for(unsigned int d=0;d<devices.size();d++){
+		ids.push_back(devices[d]());
+		sizes.push_back(binaries[d].size());
+		data.push_back(binaries[d].data());
 	}
-	smat->storage = storage;
 
-    //print_array(storage, rows*cols);
+	cl_int err;
+	std::vector<cl_int> status(devices.size(), CL_SUCCESS);
+	cl_program raw = clCreateProgramWithBinary(context(), ids.size(), ids.data(),
+			sizes.data(), data.data(), status.data(), &err);
+	if(err != CL_SUCCESS)
+		return false;
+
+	program = cl::Program(raw);
+	for(unsigned int d=0;d<status.size();d++)
+		if(status[d] != CL_SUCCESS)
+			return false;
 
-	return smat;
+	// un binario de otro driver puede no enlazar; entonces se compila la fuente
+	return program.build(devices, kernel_build_options) == CL_SUCCESS;
 }
 
-int ParallelSolver::OpenCL_init() {
+void ClProgram::save_binaries(const std::string &key) {
+
+	size_t n_devices = devices.size();
+	std::vector<size_t> sizes(n_devices, 0);
+	if(clGetProgramInfo(program(), CL_PROGRAM_BINARY_SIZES,
+			sizeof(size_t)*n_devices, sizes.data(), NULL) != CL_SUCCESS)
+		return;
+
+	ProgramBinaries binaries(n_devices);
+	std::vector<unsigned char *> data(n_devices);
+	for(unsigned int d=0;d<n_devices;d++){
+		if(sizes[d] == 0)
+			return;
+		binaries[d].resize(sizes[d]);
+		data[d] = binaries[d].data();
+	}
+
+	if(clGetProgramInfo(program(), CL_PROGRAM_BINARIES,
+			sizeof(unsigned char *)*n_devices, data.data(), NULL) != CL_SUCCESS)
+		return;
+
+	if(!write_program_cache(cache_dir, key, binaries))
+		std::cout << "Program cache: could not write " << program_cache_path(cache_dir, key) << "\n";
+}
+
+int ClProgram::build() {
+
+    if(built)
+    	return SDK_SUCCESS;
 
     cl_int err;
 
@@ -108,11 +178,18 @@ int ParallelSolver::OpenCL_init() {
         std::cout << "Platform::getInfo() failed (" << err << ")" << std::endl;
         exit(SDK_FAILURE);
     }
+    if(platforms.size() == 0)
+    {
+        std::cout << "No OpenCL platform available\n";
+        exit(SDK_FAILURE);
+    }
 
     /*
-     * If we could find our platform, use it. Otherwise pass a NULL and get whatever the
-     * implementation thinks we should be using.
+     * If we could find our platform, use it. Otherwise use the first one (i is
+     * platforms.end() after the loop and must not be dereferenced).
      */
+    if(i == platforms.end())
+    	i = platforms.begin();
 
     cl_context_properties cps[3] = { CL_CONTEXT_PLATFORM, (cl_context_properties)(*i)(), 0 };
 
@@ -124,7 +201,7 @@ int ParallelSolver::OpenCL_init() {
     }
 
     //Getting device info
-    std::vector<cl::Device> devices = context.getInfo<CL_CONTEXT_DEVICES>();
+    devices = context.getInfo<CL_CONTEXT_DEVICES>();
     if (err != CL_SUCCESS) {
         std::cout << "Context::getInfo() failed (" << err << ")\n";
         exit(SDK_FAILURE);
@@ -141,15 +218,24 @@ int ParallelSolver::OpenCL_init() {
          exit(SDK_FAILURE);
     }
 
+    std::string key;
+    if(!cache_dir.empty()){
+    	key = cache_key(file.source().data(), file.source().size());
+    	if(load_binaries(key)){
+    		built = true;
+    		return SDK_SUCCESS;
+    	}
+    }
+
     cl::Program::Sources sources(1, std::make_pair(file.source().data(), file.source().size()));
 
-    cl::Program program = cl::Program(context, sources, &err);
+    program = cl::Program(context, sources, &err);
     if (err != CL_SUCCESS) {
         std::cout << "Program::Program() failed (" << err << ")\n";
         exit(SDK_FAILURE);
     }
 
-    err = program.build(devices);
+    err = program.build(devices, kernel_build_options);
     if (err != CL_SUCCESS) {
 
         if(err == CL_BUILD_PROGRAM_FAILURE)
@@ -166,114 +252,142 @@ int ParallelSolver::OpenCL_init() {
         exit(SDK_FAILURE);
     }
 
-    kernel_local_search = cl::Kernel(program, "local_search", &err);
-    if (err != CL_SUCCESS) {
-        std::cout << "Kernel::Kernel() failed (" << err << ")\n";
-        exit(SDK_FAILURE);
-    }
+    if(!cache_dir.empty())
+    	save_binaries(key);
 
-    kernel_cost = cl::Kernel(program, "costs", &err);
-    if (err != CL_SUCCESS) {
-        std::cout << "Kernel::Kernel() failed (" << err << ")\n";
-        exit(SDK_FAILURE);
-    }
+    built = true;
+    return SDK_SUCCESS;
+}
 
-    kernel_pen_Mmax = cl::Kernel(program, "penalizaciones_Mmax", &err);
-    if (err != CL_SUCCESS) {
-        std::cout << "Kernel::Kernel() failed (" << err << ")\n";
-        exit(SDK_FAILURE);
-    }
+int ParallelSolver::OpenCL_init() {
 
-    kernel_cost_min = cl::Kernel(program, "mejor_solucion", &err);
-    if (err != CL_SUCCESS) {
-        std::cout << "Kernel::Kernel() failed (" << err << ")\n";
-        exit(SDK_FAILURE);
-    }
+    cl_int err;
 
-    // queue profiling enabled
-    queue = cl::CommandQueue(context, devices[0], CL_QUEUE_PROFILING_ENABLE, &err);
-    if (err != CL_SUCCESS) {
-        std::cout << "CommandQueue::CommandQueue() failed (" << err << ")\n";
-        exit(SDK_FAILURE);
+    // programa compartido (batch) o propio
+    if(shared_program == NULL){
+    	own_program = new ClProgram();
+    	own_program->cache_dir = cl_cache_dir;
+    	shared_program = own_program;
     }
+    shared_program->build();
 
-    // fixed input buffers
+    cl::Context &context = shared_program->context;
+    std::vector<cl::Device> &devices = shared_program->devices;
+    cl::Program &program = shared_program->program;
 
-    params = new ClParams();
-    params->max_machines_cell = max_machines_cell;
-    params->n_cells = n_cells;
-    params->n_machines = n_machines;
-    params->n_parts = n_parts;
+    // cola, kernels y buffers de tamaño fijo: una vez por objeto
+    if(!cl_ready){
 
-    buf_cl_params = cl::Buffer(context,
-    					CL_MEM_USE_HOST_PTR,
-    					sizeof(ClParams),
-    					(void *)params,
-    					&err);
+        kernel_cost = cl::Kernel(program, "costs", &err);
+        if (err != CL_SUCCESS) {
+            std::cout << "Kernel::Kernel() failed (" << err << ")\n";
+            exit(SDK_FAILURE);
+        }
 
-	StaticMatrix *static_incidence = matrix_to_StaticMatrix(incidence_matrix);
-    buf_incidence_matrix = cl::Buffer(context,
-    					CL_MEM_USE_HOST_PTR,
-    					sizeof(cl_int)*n_parts*n_machines,
-    		    		(void *)(static_incidence->storage),
-    					&err);
+        kernel_cost_min = cl::Kernel(program, "mejor_solucion", &err);
+        if (err != CL_SUCCESS) {
+            std::cout << "Kernel::Kernel() failed (" << err << ")\n";
+            exit(SDK_FAILURE);
+        }
+
+        // queue profiling enabled
+        queue = cl::CommandQueue(context, devices[0], CL_QUEUE_PROFILING_ENABLE, &err);
+        if (err != CL_SUCCESS) {
+            std::cout << "CommandQueue::CommandQueue() failed (" << err << ")\n";
+            exit(SDK_FAILURE);
+        }
 
-    // out buffer
-    //out_cost = new cl_uint[n_machines*n_machines];
-    //memset(out_cost,0,sizeof(cl_uint)*n_machines*n_machines);
+        buf_cl_params = cl::Buffer(context,
+        					CL_MEM_READ_ONLY,
+        					sizeof(ClParams),
+        					NULL,
+        					&err);
+
+        buf_min_i = cl::Buffer(context,
+        					CL_MEM_WRITE_ONLY,
+        					sizeof(cl_uint),
+        					NULL,
+        					&err);
+
+        buf_min_cost = cl::Buffer(context,
+        					CL_MEM_WRITE_ONLY,
+        					sizeof(cl_uint),
+        					NULL,
+        					&err);
+
+        // work-group del kernel de costos: potencia de 2 que acepte el dispositivo
+        size_t max_group = kernel_cost.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(devices[0]);
+        cost_local_size = 64;
+        while(cost_local_size > max_group && cost_local_size > 1)
+        	cost_local_size >>= 1;
+
+        cl_ready = true;
+    }
 
-    buf_out_cost = cl::Buffer(context,
+    // buffers por dimensión: se crean de nuevo sólo si la instancia crece
+    const Adjacency &by_part = *machines_parts;
+    int nnz = by_part.offsets[n_parts];
+
+    if(n_machines > buf_machines){
+    	//out_cost = new cl_uint[n_machines*n_machines];
+    	buf_out_cost = cl::Buffer(context,
     					CL_MEM_ALLOC_HOST_PTR,
     					sizeof(cl_uint)*n_machines*n_machines,
     					NULL, &err);
 
-    buf_cur_sol = cl::Buffer(context,
-    					CL_MEM_USE_HOST_PTR,
+    	// sólo la solución actual viaja al dispositivo, O(M) por iteración
+    	buf_cur_sol = cl::Buffer(context,
+    					CL_MEM_READ_ONLY,
     					sizeof(cl_int)*n_machines,
-    					current_solution,
-    					&err);
-
-    //gsol = new cl_int[n_machines*n_machines*n_machines];
-
-    buf_gsol = cl::Buffer(context,
-    					CL_MEM_ALLOC_HOST_PTR,//CL_MEM_USE_PERSISTENT_MEM_AMD,
-    					sizeof(cl_int)*n_machines*n_machines*n_machines,
     					NULL,
     					&err);
+    	buf_machines = n_machines;
+    }
 
-    buf_min_i = cl::Buffer(context,
-    					CL_MEM_USE_HOST_PTR,
-    					sizeof(cl_uint),
-    					&min_i,
+    // incidencia por partes (CSR), sólo los unos de la matriz
+    if(n_parts+1 > buf_parts){
+    	buf_part_offsets = cl::Buffer(context,
+    					CL_MEM_READ_ONLY,
+    					sizeof(cl_int)*(n_parts+1),
+    					NULL,
     					&err);
+    	buf_parts = n_parts+1;
+    }
 
-    buf_min_cost = cl::Buffer(context,
-    					CL_MEM_USE_HOST_PTR,
-    					sizeof(cl_uint),
-    					&min_cost,
+    // buffer de al menos un elemento aunque la matriz no tenga unos
+    if(nnz > buf_nnz || buf_nnz == 0){
+    	buf_nnz = nnz > 0 ? nnz : 1;
+    	buf_part_machines = cl::Buffer(context,
+    					CL_MEM_READ_ONLY,
+    					sizeof(cl_int)*buf_nnz,
+    					NULL,
     					&err);
+    }
 
-    cl_int status;
-
-    status = queue.flush();
-    CHECK_OPENCL_ERROR(status, "cl::CommandQueue.flush failed.");
+    params->max_machines_cell = max_machines_cell;
+    params->n_cells = n_cells;
+    params->n_machines = n_machines;
+    params->n_parts = n_parts;
 
-    // set kernel args
+    err = queue.enqueueWriteBuffer(buf_cl_params, CL_TRUE, 0, sizeof(ClParams), params);
+    CHECK_OPENCL_ERROR(err, "CommandQueue::enqueueWriteBuffer failed. (buf_cl_params)");
 
-    // kernel local search
+    err = queue.enqueueWriteBuffer(buf_part_offsets, CL_TRUE, 0,
+    		sizeof(cl_int)*(n_parts+1), by_part.offsets);
+    CHECK_OPENCL_ERROR(err, "CommandQueue::enqueueWriteBuffer failed. (buf_part_offsets)");
 
-    status = kernel_local_search.setArg(0, sizeof(ClParams*),&buf_cl_params);
-    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_cl_params)");
-
-    status = kernel_local_search.setArg(1, sizeof(cl_uint*),&buf_cur_sol);
-    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_cur_sol)");
+    if(nnz > 0){
+    	err = queue.enqueueWriteBuffer(buf_part_machines, CL_TRUE, 0,
+    			sizeof(cl_int)*nnz, by_part.indices);
+    	CHECK_OPENCL_ERROR(err, "CommandQueue::enqueueWriteBuffer failed. (buf_part_machines)");
+    }
 
-    status = kernel_local_search.setArg(2, sizeof(cl_int)*n_machines, NULL);
-    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_lsol)");
+    cl_int status;
 
-    status = kernel_local_search.setArg(3, sizeof(cl_int*),&buf_gsol);
-    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_gsol)");
+    status = queue.flush();
+    CHECK_OPENCL_ERROR(status, "cl::CommandQueue.flush failed.");
 
+    // set kernel args (los tamaños locales dependen de la instancia)
 
     // kernel cost
     status = kernel_cost.setArg(0, sizeof(cl_uint*),&buf_out_cost);
@@ -282,35 +396,30 @@ int ParallelSolver::OpenCL_init() {
     status = kernel_cost.setArg(1, sizeof(ClParams*), &buf_cl_params);
     CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_cl_params)");
 
-    status = kernel_cost.setArg(2, sizeof(cl_int*),&buf_incidence_matrix);
-    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_incidence_matrix)");
-
-    status = kernel_cost.setArg(3, sizeof(cl_int*),&buf_gsol);
-    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_gsol)");
+    status = kernel_cost.setArg(2, sizeof(cl_int*),&buf_part_offsets);
+    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_part_offsets)");
 
-    status = kernel_cost.setArg(4, sizeof(cl_int)*n_machines,NULL);
-    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (parts_cells)");
+    status = kernel_cost.setArg(3, sizeof(cl_int*),&buf_part_machines);
+    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_part_machines)");
 
-    // kernel penalización Mmax
-    status = kernel_pen_Mmax.setArg(0, sizeof(cl_uint*),&buf_out_cost);
-    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_out_cost)");
-
-    status = kernel_pen_Mmax.setArg(1, sizeof(ClParams*), &buf_cl_params);
-    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_cl_params)");
+    status = kernel_cost.setArg(4, sizeof(cl_int*),&buf_cur_sol);
+    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_cur_sol)");
 
-    status = kernel_pen_Mmax.setArg(2, sizeof(cl_int*),&buf_gsol);
-    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_gsol)");
+    status = kernel_cost.setArg(5, sizeof(cl_int)*n_machines,NULL);
+    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (cells)");
 
-    status = kernel_pen_Mmax.setArg(3, sizeof(cl_int*), NULL);
-    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_machines_cell)");
+    status = kernel_cost.setArg(6, sizeof(cl_uint)*n_cells,NULL);
+    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (machines_cell)");
 
+    status = kernel_cost.setArg(7, sizeof(cl_uint)*cost_local_size,NULL);
+    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (partial)");
 
     // kernel reducción costo mínimo
     status = kernel_cost_min.setArg(0, sizeof(cl_uint*),&buf_out_cost);
     CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_out_cost)");
 
-    status = kernel_cost_min.setArg(1, sizeof(cl_int*),&buf_gsol);
-    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_gsol)");
+    status = kernel_cost_min.setArg(1, sizeof(ClParams*), &buf_cl_params);
+    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_cl_params)");
 
     status = kernel_cost_min.setArg(2, sizeof(cl_uint*), &buf_min_i);
     CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_min_i)");
@@ -318,10 +427,22 @@ int ParallelSolver::OpenCL_init() {
     status = kernel_cost_min.setArg(3, sizeof(cl_uint*), &buf_min_cost);
     CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (buf_min_cost)");
 
+    status = kernel_cost_min.setArg(4, sizeof(cl_uint)*cost_local_size, NULL);
+    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (local_cost)");
+
+    status = kernel_cost_min.setArg(5, sizeof(cl_uint)*cost_local_size, NULL);
+    CHECK_OPENCL_ERROR(status, "Kernel::setArg() failed. (local_i)");
+
+    // memoria local del kernel de costos: cells, machines_cell y partial
+    cl_ulong local_needed = sizeof(cl_int)*n_machines + sizeof(cl_uint)*n_cells +
+    		sizeof(cl_uint)*cost_local_size;
+    cl_ulong local_available = devices[0].getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+    if(local_needed > local_available){
+    	std::cout << "Instance needs " << local_needed << " bytes of local memory, device has "
+    			<< local_available << "\n";
+    	exit(SDK_FAILURE);
+    }
 
-    //std::cout << "delete" << std::endl;
-    delete[] static_incidence->storage;
-    delete static_incidence;
 
     //std::cout << "return" << std::endl;
     return SDK_SUCCESS;
@@ -340,139 +461,81 @@ int ParallelSolver::local_search(){
     cl_int err;
     /////////////////////////runCLKernels////////////////////////////////////////
 
-    cl::Event writeEvt1,writeEvt2,writeEvt3,writeEvt4;
-
-    out_cost = (cl_uint *)queue.enqueueMapBuffer(buf_out_cost,CL_FALSE,CL_MAP_WRITE,0,sizeof(cl_uint)*n_machines*n_machines,NULL,&writeEvt2,&err);
-    CHECK_OPENCL_ERROR(err, "CommandQueue::enqueueMapBuffer failed. (buf_out_cost)");
+    cl::Event writeEvt;
 
-    gsol = (cl_int *)queue.enqueueMapBuffer(buf_gsol,CL_FALSE,CL_MAP_WRITE,0,sizeof(cl_int)*n_machines*n_machines*n_machines,NULL,&writeEvt1,&err);
-    CHECK_OPENCL_ERROR(err, "CommandQueue::enqueueMapBuffer failed. (buf_gsol)");
-
-    err = queue.flush();
-    CHECK_OPENCL_ERROR(err, "cl::CommandQueue.flush failed.");
+    // solución actual; las candidatas se derivan en el kernel
+    err = queue.enqueueWriteBuffer(buf_cur_sol, CL_FALSE, 0, sizeof(cl_int)*n_machines,
+    		current_solution->cell_vector, NULL, &writeEvt);
+    CHECK_OPENCL_ERROR(err, "CommandQueue::enqueueWriteBuffer failed. (buf_cur_sol)");
 
     std::vector<cl::Event> write_events;
-    write_events.push_back(writeEvt1);
-    write_events.push_back(writeEvt2);
-    cl::WaitForEvents(write_events);
-
-    // llenar buffer gsol
-    for(unsigned int i=0;i<n_machines*n_machines;i++){
-    	memcpy(gsol+(i*n_machines),current_solution->cell_vector,sizeof(cl_int)*n_machines);
-    }
-
-    //reset cost buffer
-    memset(out_cost,0,sizeof(cl_uint)*n_machines*n_machines);
-    min_cost = UINT_MAX;
+    write_events.push_back(writeEvt);
 
-	err = queue.enqueueUnmapMemObject(buf_gsol,gsol,NULL,&writeEvt3);
-    CHECK_OPENCL_ERROR(err, "CommandQueue::enqueueUnMapMemObject failed. (buf_gsol)");
-
-	err = queue.enqueueUnmapMemObject(buf_out_cost,out_cost,NULL,&writeEvt4);
-    CHECK_OPENCL_ERROR(err, "CommandQueue::enqueueUnMapMemObject failed. (buf_out_cost)");
-
-    err = queue.flush();
-    CHECK_OPENCL_ERROR(err, "cl::CommandQueue.flush failed.");
-
-	write_events.clear();
-    write_events.push_back(writeEvt3);
-    write_events.push_back(writeEvt4);
-    cl::WaitForEvents(write_events);
-
-    cl::NDRange globalThreads_local_search(n_machines,n_machines);
-    cl::NDRange globalThreads_cost(n_machines*n_machines*n_machines, n_machines,n_parts);
-    cl::NDRange localThreads_cost(n_machines,n_machines,1);
-    cl::NDRange globalThreads_pen_Mmax(n_cells,n_machines*n_machines,n_machines);
-    cl::NDRange localThreads_pen_Mmax(1,1,n_machines);
-    cl::NDRange globalThreads_cost_min(n_machines*n_machines);
-    cl::Event ndrEvt;
-    cl::Event kernel_local_search_evt;
+    // un work-group por candidata (i,j)
+    cl::NDRange globalThreads_cost(n_machines*n_machines*cost_local_size);
+    cl::NDRange localThreads_cost(cost_local_size);
+    cl::NDRange globalThreads_cost_min(cost_local_size);
+    cl::NDRange localThreads_cost_min(cost_local_size);
     cl::Event kernel_costos_evt;
-    cl::Event kernel_penMmax_evt;
     cl::Event kernel_cost_min_evt;
 
     // kernel de costos ---------------------------------
     err = queue.enqueueNDRangeKernel(
-    		kernel_local_search,cl::NullRange, globalThreads_local_search, cl::NullRange, NULL, &kernel_local_search_evt
-    );
-
-    if (err != CL_SUCCESS) { std::cout << "CommandQueue::enqueueNDRangeKernel() failed (" << err << ")\n"; }
-
-    err = queue.enqueueNDRangeKernel(
-    		kernel_cost,cl::NullRange, globalThreads_cost, localThreads_cost, 0, &kernel_costos_evt
+    		kernel_cost,cl::NullRange, globalThreads_cost, localThreads_cost, &write_events, &kernel_costos_evt
     );
 
-    if (err != CL_SUCCESS) { std::cout << "CommandQueue::enqueueNDRangeKernel() failed (" << err << ")\n"; }
-
-    err = queue.enqueueNDRangeKernel(
-    		kernel_pen_Mmax,cl::NullRange, globalThreads_pen_Mmax, localThreads_pen_Mmax, 0, &kernel_penMmax_evt
-    );
-
-    if (err != CL_SUCCESS) { std::cout << "CommandQueue::enqueueNDRangeKernel() failed (" << err << ")\n"; }
+    if (err != CL_SUCCESS) {
+        std::cout << "CommandQueue::enqueueNDRangeKernel() failed (" << err << ")\n";
+        exit(SDK_FAILURE);
+    }
 
     err = queue.enqueueNDRangeKernel(
-    		kernel_cost_min,cl::NullRange, globalThreads_cost_min, cl::NullRange, 0, &kernel_cost_min_evt
+    		kernel_cost_min,cl::NullRange, globalThreads_cost_min, localThreads_cost_min, 0, &kernel_cost_min_evt
     );
 
-    if (err != CL_SUCCESS) { std::cout << "CommandQueue::enqueueNDRangeKernel() failed (" << err << ")\n"; }
+    if (err != CL_SUCCESS) {
+        std::cout << "CommandQueue::enqueueNDRangeKernel() failed (" << err << ")\n";
+        exit(SDK_FAILURE);
+    }
 
     err=queue.flush();
     CHECK_OPENCL_ERROR(err, "cl::CommandQueue.flush failed.");
 
     std::vector<cl::Event> events;
-    events.push_back(kernel_local_search_evt);
     events.push_back(kernel_costos_evt);
-    events.push_back(kernel_penMmax_evt);
     events.push_back(kernel_cost_min_evt);
 
     cl::WaitForEvents(events);
 
-     Solution *local_best = new Solution(n_machines);
-     // Enqueue readBuffer
-     cl::Event readEvt3;
-
-     gsol = (cl_int *)queue.enqueueMapBuffer(buf_gsol,CL_FALSE,CL_MAP_READ,0,sizeof(cl_int)*n_machines*n_machines*n_machines,NULL,&readEvt3,&err);
-     CHECK_OPENCL_ERROR(err, "CommandQueue::enqueueMapBuffer failed. (buf_min_cost)");
-
-     err = queue.flush();
-     CHECK_OPENCL_ERROR(err, "cl::CommandQueue.flush failed.");
-
-     std::vector<cl::Event> read_events;
-     read_events.push_back(readEvt3);
-
-     cl::WaitForEvents(read_events);
-
-     memcpy(local_best->cell_vector,gsol+min_i,sizeof(cl_int)*n_machines);
-
-     //TODO
-	 printf("min_cost: %i\n",min_cost);
-     min_cost = get_cost(local_best);
-
-     //local_best->cost = get_cost(local_best);
-     local_best->cost = min_cost;
+    // tiempo de kernels (ns) por profiling de la cola
+    for(unsigned int e=0;e<events.size();e++){
+    	cl_ulong kernel_start = events[e].getProfilingInfo<CL_PROFILING_COMMAND_START>();
+    	cl_ulong kernel_end = events[e].getProfilingInfo<CL_PROFILING_COMMAND_END>();
+    	iter_cost_time += kernel_end - kernel_start;
+    }
+    n_evaluations += n_machines*(n_machines-1)/2;
 
- 	 err = queue.enqueueUnmapMemObject(buf_gsol,gsol,NULL,&readEvt3);
-     CHECK_OPENCL_ERROR(err, "CommandQueue::enqueueUnMapMemObject failed. (buf_gsol)");
+    // mejor candidata: costo exacto calculado en el dispositivo
+    err = queue.enqueueReadBuffer(buf_min_i, CL_TRUE, 0, sizeof(cl_uint), &min_i);
+    CHECK_OPENCL_ERROR(err, "CommandQueue::enqueueReadBuffer failed. (buf_min_i)");
 
-     err = queue.flush();
-     CHECK_OPENCL_ERROR(err, "cl::CommandQueue.flush failed.");
+    err = queue.enqueueReadBuffer(buf_min_cost, CL_TRUE, 0, sizeof(cl_uint), &min_cost);
+    CHECK_OPENCL_ERROR(err, "CommandQueue::enqueueReadBuffer failed. (buf_min_cost)");
 
-	 delete current_solution;
+    if(min_cost == UINT_MAX)
+    	return 0; // sin movimientos (n_machines < 2)
 
-	 current_solution = local_best;
+    std::swap(current_solution->cell_vector[min_i/n_machines],
+    		current_solution->cell_vector[min_i%n_machines]);
+    current_solution->cost = min_cost;
 
 	if(min_cost < (uint)global_best_cost){
-		delete global_best;
-		global_best = current_solution->clone();
+		builder->destroy_solution(global_best);
+		global_best = builder->copy_solution(current_solution);
 		global_best_cost = min_cost;
 	}
 
-     read_events.clear();
-     read_events.push_back(readEvt3);
-
-     cl::WaitForEvents(read_events);
-
-	 return 0;
+	return 0;
 }
 
 } /* namespace tabu */
@@ -18,17 +18,10 @@
 #include <SDKUtil/SDKApplication.hpp>
 #include <SDKUtil/SDKCommandArgs.hpp>
 #include "Solver.h"
+#include "ProgramCache.h"
 
 namespace tabu {
 
-class StaticMatrix {
-
-	public:
-		cl_int rows;
-		cl_int cols;
-		cl_int *storage;
-};
-
 class VariableMatrix {
 
 	public:
@@ -45,6 +38,35 @@ typedef struct cl_params {
 	cl_int max_machines_cell;
 } ClParams;
 
+/*
+ * Contexto, dispositivos y programa OpenCL compilado. build() lo hace una
+ * sola vez; un batch lo comparte entre sus ParallelSolver, que crean sus
+ * propias colas, kernels y buffers. Con cache_dir el binario compilado se
+ * guarda en disco (ProgramCache) y las ejecuciones siguientes lo cargan
+ * con clCreateProgramWithBinary en vez de compilar la fuente.
+ */
+class ClProgram {
+public:
+	ClProgram();
+	int build();
+	cl::Context context;
+	std::vector<cl::Device> devices;
+	cl::Program program;
+	std::string cache_dir; // vacío: sin caché de binarios
+private:
+	std::string cache_key(const char *source, size_t size);
+	bool load_binaries(const std::string &key);
+	void save_binaries(const std::string &key);
+	bool built;
+};
+
+/*
+ * Búsqueda local con el costo de todo el vecindario evaluado en OpenCL.
+ * Cola, kernels y buffers se crean en el primer init() y se reutilizan en
+ * las corridas siguientes del mismo objeto (set_problem, Session): los
+ * buffers sólo se vuelven a crear si las dimensiones crecen, y los datos
+ * de la instancia se copian con enqueueWriteBuffer.
+ */
 class ParallelSolver: public tabu::Solver {
 public:
 	ParallelSolver(unsigned int max_iterations, int diversification_param,
@@ -52,27 +74,29 @@ public:
 			unsigned int max_machines_cell, Matrix *incidence_matrix,
 			int tabu_turns);
 	virtual ~ParallelSolver();
+	ClProgram *shared_program; // NULL: se crea uno propio en init()
+	std::string cl_cache_dir;  // cache_dir del programa propio
 
 private:
-	cl::Context context;
-	cl::Kernel kernel_local_search;
+	ClProgram *own_program;
 	cl::Kernel kernel_cost;
-	cl::Kernel kernel_pen_Mmax;
 	cl::Kernel kernel_cost_min;
 	cl::CommandQueue queue;
 	int local_search();
-	long get_cpu_cost(Solution *solution);
 	int OpenCL_init();
 	void init();
-	StaticMatrix *matrix_to_StaticMatrix(Matrix *mat);
+	bool cl_ready;            // cola y kernels creados
+	unsigned int buf_machines; // capacidad de los buffers
+	unsigned int buf_parts;
+	int buf_nnz;
 	ClParams *params;
 	cl_uint *out_cost;
+	size_t cost_local_size;
 	cl::Buffer buf_out_cost;
     cl::Buffer buf_cl_params;
-    cl::Buffer buf_incidence_matrix;
+    cl::Buffer buf_part_offsets;
+    cl::Buffer buf_part_machines;
     cl::Buffer buf_cur_sol;
-    cl_int *gsol;
-    cl::Buffer buf_gsol;
     cl_uint min_i;
     cl::Buffer buf_min_i;
     cl_uint min_cost;
@@ -0,0 +1,149 @@
+#include "Portfolio.h"
+#include "Timer.h"
+#include <cstdio>
+
+namespace tabu {
+
+Portfolio::Portfolio(unsigned int n_runs, unsigned int n_threads,
+		unsigned int seed, unsigned int max_iterations,
+		int diversification_param, unsigned int n_machines,
+		unsigned int n_parts, unsigned int n_cells,
+		unsigned int max_machines_cell, Matrix *incidence_matrix,
+		int tabu_turns) {
+
+	if(n_threads == 0)
+		n_threads = std::thread::hardware_concurrency();
+	if(n_threads == 0)
+		n_threads = 1;
+	if(n_threads > n_runs)
+		n_threads = n_runs;
+
+	this->n_threads = n_threads;
+	this->n_machines = n_machines;
+	this->next_run = 0;
+	this->best_solver = NULL;
+	this->candidate_list_period = 0;
+	this->time_budget = 0;
+	this->stagnation_limit = 0;
+	this->target_cost = -1;
+	this->diversification_candidates = 1;
+	this->migration_period = 0;
+	this->migration_topology = MIGRATION_RING;
+	this->elite_size = 0;
+	this->relink_period = 0;
+
+	// los solvers se crean en este hilo: row_index() y col_index() quedan
+	// calculados antes de que las corridas los lean en paralelo. La cota
+	// inferior es la misma para todas las corridas y se calcula una vez.
+	long bound = exceptional_lower_bound(incidence_matrix->col_index(),
+			n_machines, n_parts, n_cells, max_machines_cell);
+	for(unsigned int r=0;r<n_runs;r++){
+		Solver *solver = new Solver(max_iterations, diversification_param,
+				n_machines, n_parts, n_cells, max_machines_cell,
+				incidence_matrix, tabu_turns);
+		solver->seed = seed + r;
+		solver->known_bound = bound;
+		solver->verbosity = TRACE_NONE;
+		solvers.push_back(solver);
+
+		RunStats run = { r, seed + r, -1, 0, 0.0, STOP_ITERATIONS, 0 };
+		stats.push_back(run);
+	}
+}
+
+Portfolio::~Portfolio() {
+	for(unsigned int r=0;r<solvers.size();r++)
+		delete solvers[r];
+}
+
+void Portfolio::run_worker(unsigned int) {
+
+	while(true){
+		unsigned int r;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if(next_run == solvers.size())
+				return;
+			r = next_run++;
+		}
+
+		double start = wall_time();
+		solvers[r]->solve();
+		double elapsed = wall_time() - start;
+
+		stats[r].best_cost = solvers[r]->global_best_cost;
+		stats[r].iterations = solvers[r]->n_iterations;
+		stats[r].seconds = elapsed;
+		stats[r].stop_reason = solvers[r]->stop_reason;
+		stats[r].immigrants = solvers[r]->immigrants;
+	}
+}
+
+Solution *Portfolio::solve() {
+
+	next_run = 0;
+	for(unsigned int r=0;r<solvers.size();r++){
+		solvers[r]->candidate_list_period = candidate_list_period;
+		solvers[r]->time_budget = time_budget;
+		solvers[r]->stagnation_limit = stagnation_limit;
+		solvers[r]->target_cost = target_cost;
+		solvers[r]->diversification_candidates = diversification_candidates;
+		solvers[r]->elite_size = elite_size;
+		solvers[r]->relink_period = relink_period;
+	}
+
+	// las islas deben correr a la vez para intercambiar élites
+	Migration *migration = NULL;
+	unsigned int workers = n_threads;
+	if(migration_period > 0 && solvers.size() > 1){
+		// stats[r].seed es seed+r: la isla r usa la semilla de su corrida
+		migration = new Migration(solvers.size(), n_machines, migration_topology,
+				stats[0].seed);
+		workers = solvers.size();
+	}
+	for(unsigned int r=0;r<solvers.size();r++){
+		solvers[r]->migration = migration;
+		solvers[r]->island = r;
+		solvers[r]->migration_period = migration_period;
+	}
+
+	{
+		WorkerPool pool(workers);
+		pool.run(std::bind(&Portfolio::run_worker, this, std::placeholders::_1));
+	}
+
+	for(unsigned int r=0;r<solvers.size();r++)
+		solvers[r]->migration = NULL;
+	delete migration;
+
+	// mejor corrida, desempate por número de corrida
+	best_solver = NULL;
+	for(unsigned int r=0;r<solvers.size();r++){
+		if(best_solver == NULL || solvers[r]->global_best_cost < best_solver->global_best_cost)
+			best_solver = solvers[r];
+	}
+
+	return best_solver != NULL ? best_solver->global_best : NULL;
+}
+
+const std::vector<Solver *> &Portfolio::runs() const {
+	return solvers;
+}
+
+void Portfolio::print_stats() {
+
+	printf("\n%-5s %-12s %-10s %-10s %-10s %-10s", "run", "seed", "cost", "iter", "seconds", "stop");
+	if(migration_period > 0)
+		printf(" %-10s", "immigrants");
+	printf("\n");
+	for(unsigned int r=0;r<stats.size();r++){
+		printf("%-5u %-12u %-10i %-10u %-10.3f %-10s", stats[r].run, stats[r].seed,
+				stats[r].best_cost, stats[r].iterations, stats[r].seconds,
+				stop_reason_name(stats[r].stop_reason));
+		if(migration_period > 0)
+			printf(" %-10u", stats[r].immigrants);
+		printf("\n");
+	}
+}
+
+} /* namespace tabu */
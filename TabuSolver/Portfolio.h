@@ -0,0 +1,65 @@
+#ifndef PORTFOLIO_H_
+#define PORTFOLIO_H_
+
+#include <vector>
+#include "Solver.h"
+#include "WorkerPool.h"
+
+namespace tabu {
+
+// resultado de una corrida del portafolio
+typedef struct run_stats {
+
+	unsigned int run;
+	unsigned int seed;
+	int best_cost;
+	unsigned int iterations;
+	double seconds;
+	int stop_reason;
+	unsigned int immigrants;
+} RunStats;
+
+/*
+ * Portafolio multi-start: n_runs búsquedas tabú independientes repartidas
+ * en n_threads hilos dentro del mismo proceso. La Matrix (y sus índices)
+ * se comparte en sólo lectura; cada corrida tiene su propio Solver con
+ * semilla seed+run.
+ *
+ * Con migration_period > 0 las corridas son islas: corren todas a la vez
+ * (un hilo por isla) y cada migration_period iteraciones publican su mejor
+ * global y adoptan la de una vecina (Migration) si es mejor. La primera
+ * que llega al óptimo o al objetivo detiene a las demás.
+ */
+class Portfolio {
+public:
+	Portfolio(unsigned int n_runs, unsigned int n_threads, unsigned int seed,
+			unsigned int max_iterations, int diversification_param,
+			unsigned int n_machines, unsigned int n_parts, unsigned int n_cells,
+			unsigned int max_machines_cell, Matrix *incidence_matrix,
+			int tabu_turns);
+	virtual ~Portfolio();
+	Solution *solve();
+	void print_stats();
+	const std::vector<Solver *> &runs() const;
+	std::vector<RunStats> stats;
+	Solver *best_solver;
+	unsigned int candidate_list_period; // se copian a cada Solver en solve()
+	double time_budget;
+	unsigned int stagnation_limit;
+	int target_cost;
+	unsigned int diversification_candidates;
+	unsigned int migration_period; // 0: corridas independientes
+	int migration_topology;        // MigrationTopology
+	unsigned int elite_size;
+	unsigned int relink_period;
+private:
+	void run_worker(unsigned int worker);
+	std::vector<Solver *> solvers;
+	unsigned int n_threads;
+	unsigned int n_machines;
+	unsigned int next_run;
+	std::mutex mutex;
+};
+
+} /* namespace tabu */
+#endif /* PORTFOLIO_H_ */
@@ -0,0 +1,56 @@
+#include "Profile.h"
+
+namespace tabu {
+
+#ifdef TABU_PROFILE
+const bool Profile::enabled = true;
+#else
+const bool Profile::enabled = false;
+#endif
+
+static const char *phase_names[PROFILE_PHASES] = {
+	"init", "local_search", "global_search", "update_tabu"
+};
+
+static const char *counter_names[PROFILE_COUNTERS] = {
+	"cost_evaluations", "swap_evaluations", "tabu_lookups", "allocations"
+};
+
+Profile::Profile() {
+	clear();
+}
+
+void Profile::clear() {
+	for(int p=0;p<PROFILE_PHASES;p++){
+		seconds[p] = 0;
+		calls[p] = 0;
+	}
+	for(int c=0;c<PROFILE_COUNTERS;c++)
+		counters[c] = 0;
+}
+
+void Profile::add(const Profile &other) {
+	for(int p=0;p<PROFILE_PHASES;p++){
+		seconds[p] += other.seconds[p];
+		calls[p] += other.calls[p];
+	}
+	for(int c=0;c<PROFILE_COUNTERS;c++)
+		counters[c] += other.counters[c];
+}
+
+void Profile::write_json(FILE *file) const {
+
+	fprintf(file, "{\"phases\": {");
+	for(int p=0;p<PROFILE_PHASES;p++){
+		fprintf(file, "%s\"%s\": {\"seconds\": %.9f, \"calls\": %lu}",
+				p > 0 ? ", " : "", phase_names[p], seconds[p], calls[p]);
+	}
+	fprintf(file, "}, \"counters\": {");
+	for(int c=0;c<PROFILE_COUNTERS;c++){
+		fprintf(file, "%s\"%s\": %lu", c > 0 ? ", " : "", counter_names[c],
+				counters[c]);
+	}
+	fprintf(file, "}}");
+}
+
+} /* namespace tabu */
@@ -0,0 +1,68 @@
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <cstdio>
+#include "Timer.h"
+
+namespace tabu {
+
+enum ProfilePhase {
+	PROFILE_INIT,
+	PROFILE_LOCAL_SEARCH,
+	PROFILE_GLOBAL_SEARCH,
+	PROFILE_UPDATE_TABU,
+	PROFILE_PHASES
+};
+
+enum ProfileCounter {
+	PROFILE_COST_EVALUATIONS, // get_cost completos
+	PROFILE_SWAP_EVALUATIONS, // vecinos evaluados (n_evaluations)
+	PROFILE_TABU_LOOKUPS,
+	PROFILE_ALLOCATIONS,      // Solutions nuevas del SolutionBuilder
+	PROFILE_COUNTERS
+};
+
+/*
+ * Tiempos de pared por fase y contadores de una corrida. Con -DTABU_PROFILE
+ * las macros PROFILE_SCOPE y PROFILE_ADD los llenan; sin él se expanden a
+ * nada y sólo quedan los contadores que el solver lleva de todas formas
+ * (swap_evaluations, allocations).
+ */
+class Profile {
+public:
+	Profile();
+	void clear();
+	void add(const Profile &other);
+	void write_json(FILE *file) const;
+	double seconds[PROFILE_PHASES];
+	unsigned long calls[PROFILE_PHASES];
+	unsigned long counters[PROFILE_COUNTERS];
+	static const bool enabled;
+};
+
+// mide la fase desde su construcción hasta el fin del bloque
+class ProfileScope {
+public:
+	ProfileScope(Profile &profile, int phase) : profile(profile), phase(phase) {
+		start = wall_time();
+	}
+	~ProfileScope() {
+		profile.seconds[phase] += wall_time() - start;
+		profile.calls[phase]++;
+	}
+private:
+	Profile &profile;
+	int phase;
+	double start;
+};
+
+#ifdef TABU_PROFILE
+#define PROFILE_SCOPE(profile, phase) ProfileScope profile_scope(profile, phase)
+#define PROFILE_ADD(counter, n) ((counter) += (n))
+#else
+#define PROFILE_SCOPE(profile, phase) do {} while(0)
+#define PROFILE_ADD(counter, n) do {} while(0)
+#endif
+
+} /* namespace tabu */
+#endif /* PROFILE_H_ */
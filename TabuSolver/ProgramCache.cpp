@@ -0,0 +1,112 @@
+#include "ProgramCache.h"
+#include "Hash.h"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tabu {
+
+typedef struct program_cache_header {
+
+	char magic[8];
+	uint32_t version;
+	uint32_t key_size;
+	uint32_t n_binaries;
+} ProgramCacheHeader;
+
+std::string program_cache_path(const std::string &dir, const std::string &key) {
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.clbin",
+			(unsigned long long)fnv1a_hash(key.data(), key.size()));
+	return dir + "/" + name;
+}
+
+bool read_program_cache(const std::string &path, const std::string &key,
+		unsigned int n_devices, ProgramBinaries &binaries) {
+
+	FILE *file;
+	if((file = fopen(path.c_str(), "rb")) == NULL)
+		return false;
+
+	// nada del encabezado se usa para asignar memoria sin validarlo contra
+	// la llave, el número de dispositivos y el tamaño del archivo
+	struct stat st;
+	ProgramCacheHeader h;
+	std::string stored;
+	std::vector<uint64_t> sizes;
+	bool ok = fstat(fileno(file), &st) == 0 &&
+			fread(&h, sizeof(h), 1, file) == 1 &&
+			memcmp(h.magic, PROGRAM_CACHE_MAGIC, 8) == 0 &&
+			h.version == PROGRAM_CACHE_VERSION && h.key_size == key.size() &&
+			h.n_binaries == n_devices;
+
+	// bytes tras la llave y la tabla de tamaños
+	uint64_t table = sizeof(h) + (uint64_t)h.key_size + (uint64_t)h.n_binaries*sizeof(uint64_t);
+	ok = ok && (uint64_t)st.st_size >= table;
+	uint64_t left = ok ? st.st_size - table : 0;
+
+	if(ok){
+		stored.resize(h.key_size);
+		sizes.resize(h.n_binaries);
+		ok = fread(&stored[0], 1, h.key_size, file) == h.key_size &&
+				stored == key &&
+				fread(sizes.data(), sizeof(uint64_t), h.n_binaries, file) == h.n_binaries;
+	}
+
+	binaries.clear();
+	for(unsigned int d=0;ok && d<h.n_binaries;d++){
+		ok = sizes[d] > 0 && sizes[d] <= left;
+		if(!ok)
+			break;
+		left -= sizes[d];
+		binaries.push_back(std::vector<unsigned char>(sizes[d]));
+		ok = fread(binaries[d].data(), 1, sizes[d], file) == sizes[d];
+	}
+
+	fclose(file);
+	if(!ok)
+		binaries.clear();
+	return ok;
+}
+
+bool write_program_cache(const std::string &dir, const std::string &key,
+		const ProgramBinaries &binaries) {
+
+	if(mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+		return false;
+
+	std::string path = program_cache_path(dir, key);
+	char pid[32];
+	snprintf(pid, sizeof(pid), ".%d.tmp", (int)getpid());
+	std::string tmp = path + pid;
+	FILE *file;
+	if((file = fopen(tmp.c_str(), "wb")) == NULL)
+		return false;
+
+	ProgramCacheHeader h;
+	memcpy(h.magic, PROGRAM_CACHE_MAGIC, 8);
+	h.version = PROGRAM_CACHE_VERSION;
+	h.key_size = key.size();
+	h.n_binaries = binaries.size();
+
+	std::vector<uint64_t> sizes;
+	for(unsigned int d=0;d<binaries.size();d++)
+		sizes.push_back(binaries[d].size());
+
+	bool ok = fwrite(&h, sizeof(h), 1, file) == 1 &&
+			fwrite(key.data(), 1, key.size(), file) == key.size() &&
+			fwrite(sizes.data(), sizeof(uint64_t), sizes.size(), file) == sizes.size();
+	for(unsigned int d=0;ok && d<binaries.size();d++)
+		ok = fwrite(binaries[d].data(), 1, binaries[d].size(), file) == binaries[d].size();
+	ok = fclose(file) == 0 && ok;
+
+	if(!ok || rename(tmp.c_str(), path.c_str()) != 0){
+		remove(tmp.c_str());
+		return false;
+	}
+	return true;
+}
+
+} /* namespace tabu */
@@ -0,0 +1,37 @@
+#ifndef PROGRAMCACHE_H_
+#define PROGRAMCACHE_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace tabu {
+
+/*
+ * Caché en disco de binarios de programas OpenCL. La llave es un texto con
+ * el hash de la fuente del kernel, nombre y versión del driver de cada
+ * dispositivo y las opciones de compilación; el archivo es
+ * <dir>/<hash de la llave>.clbin y guarda la llave completa, que se compara
+ * al leer (un choque de hash es un fallo de caché, no un binario ajeno).
+ * Formato: magic "TABUCLBN", version, largo de la llave, n_binaries, la
+ * llave, n_binaries tamaños uint64_t y los binarios, uno por dispositivo.
+ * Se escribe en un .<pid>.tmp y se renombra, así que procesos concurrentes leen
+ * un archivo completo o ninguno.
+ */
+#define PROGRAM_CACHE_MAGIC "TABUCLBN"
+#define PROGRAM_CACHE_VERSION 1
+
+typedef std::vector<std::vector<unsigned char> > ProgramBinaries;
+
+std::string program_cache_path(const std::string &dir, const std::string &key);
+
+// false (fallo de caché) si el archivo no existe, no es de la llave, no
+// tiene n_devices binarios o algún tamaño no cabe en lo que queda del archivo
+bool read_program_cache(const std::string &path, const std::string &key,
+		unsigned int n_devices, ProgramBinaries &binaries);
+
+bool write_program_cache(const std::string &dir, const std::string &key,
+		const ProgramBinaries &binaries);
+
+} /* namespace tabu */
+#endif /* PROGRAMCACHE_H_ */
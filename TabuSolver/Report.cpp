@@ -0,0 +1,59 @@
+#include "Report.h"
+#include <cstdio>
+
+namespace tabu {
+
+static void write_string(FILE *file, const std::string &value) {
+	fputc('"', file);
+	for(unsigned int c=0;c<value.size();c++){
+		if(value[c] == '"' || value[c] == '\\')
+			fputc('\\', file);
+		fputc(value[c], file);
+	}
+	fputc('"', file);
+}
+
+bool write_json_report(const char *filename, const std::string &instance,
+		const std::string &backend, const std::vector<Solver *> &runs) {
+
+	FILE *file;
+	if((file = fopen(filename, "w")) == NULL)
+		return false;
+
+	Profile total;
+	int best_cost = -1;
+	for(unsigned int r=0;r<runs.size();r++){
+		total.add(runs[r]->profile);
+		if(best_cost < 0 || runs[r]->global_best_cost < best_cost)
+			best_cost = runs[r]->global_best_cost;
+	}
+
+	fprintf(file, "{\n  \"instance\": ");
+	write_string(file, instance);
+	fprintf(file, ",\n  \"backend\": ");
+	write_string(file, backend);
+	fprintf(file, ",\n  \"profiling\": %s,\n  \"best_cost\": %d,\n  \"runs\": [",
+			Profile::enabled ? "true" : "false", best_cost);
+
+	for(unsigned int r=0;r<runs.size();r++){
+		const Solver *s = runs[r];
+		fprintf(file, "%s\n    {\"seed\": %u, \"best_cost\": %d, \"iterations\": %u, "
+				"\"evaluations\": %lu, \"elapsed_seconds\": %.6f, \"stop_reason\": \"%s\", "
+				"\"lower_bound\": %ld, \"immigrants\": %u, \"relinks\": %u, "
+				"\"profile\": ",
+				r > 0 ? "," : "", s->seed, s->global_best_cost, s->n_iterations,
+				s->n_evaluations, s->elapsed_time, stop_reason_name(s->stop_reason),
+				s->lower_bound.load(), s->immigrants, s->relinks);
+		s->profile.write_json(file);
+		fprintf(file, "}");
+	}
+
+	fprintf(file, "\n  ],\n  \"total\": ");
+	total.write_json(file);
+	fprintf(file, "\n}\n");
+
+	bool ok = !ferror(file);
+	return fclose(file) == 0 && ok;
+}
+
+} /* namespace tabu */
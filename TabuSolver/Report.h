@@ -0,0 +1,19 @@
+#ifndef REPORT_H_
+#define REPORT_H_
+
+#include <string>
+#include <vector>
+#include "Solver.h"
+
+namespace tabu {
+
+/*
+ * Reporte JSON (-J) de una ejecución: por cada corrida (un Solver, o las
+ * del portafolio) semilla, costo, iteraciones, tiempo de pared, motivo de
+ * término, cota inferior y su Profile, más la suma de todos los Profile en "total".
+ */
+bool write_json_report(const char *filename, const std::string &instance,
+		const std::string &backend, const std::vector<Solver *> &runs);
+
+} /* namespace tabu */
+#endif /* REPORT_H_ */
@@ -0,0 +1,69 @@
+#include "Session.h"
+
+namespace tabu {
+
+Session::Session(const std::string &backend, unsigned int n_threads,
+		ClProgram *shared_program) {
+	this->backend = backend;
+	this->n_threads = n_threads;
+	this->solver = NULL;
+	this->shared_program = shared_program;
+}
+
+Session::~Session() {
+	delete solver;
+}
+
+Solver *Session::create_solver(Matrix *instance, const SolveParams &params) {
+
+	if(backend == "opencl"){
+		ParallelSolver *parallel = new ParallelSolver(params.iterations,
+				params.diversification_param, instance->rows, instance->cols,
+				params.cells, params.max_machines_cell, instance,
+				params.tabu_turns);
+		parallel->shared_program = shared_program;
+		parallel->cl_cache_dir = cl_cache_dir;
+		return parallel;
+	}
+
+	if(backend == "threaded")
+		return new ThreadedSolver(params.iterations,
+				params.diversification_param, instance->rows, instance->cols,
+				params.cells, params.max_machines_cell, instance,
+				params.tabu_turns, n_threads);
+
+	return new Solver(params.iterations, params.diversification_param,
+			instance->rows, instance->cols, params.cells,
+			params.max_machines_cell, instance, params.tabu_turns);
+}
+
+Solution *Session::solve(Matrix *instance, const SolveParams &params) {
+
+	if(solver == NULL){
+		solver = create_solver(instance, params);
+		solver->verbosity = TRACE_NONE;
+	} else {
+		solver->set_problem(instance, instance->rows, instance->cols,
+				params.cells, params.max_machines_cell);
+		solver->set_parameters(params.iterations, params.diversification_param,
+				params.tabu_turns);
+	}
+
+	solver->seed = params.seed;
+	solver->candidate_list_period = params.candidate_list_period;
+	solver->time_budget = params.time_budget;
+	solver->stagnation_limit = params.stagnation_limit;
+	solver->target_cost = params.target_cost;
+	solver->diversification_candidates = params.diversification_candidates;
+	solver->elite_size = params.elite_size;
+	solver->relink_period = params.relink_period;
+	solver->known_bound = params.lower_bound;
+
+	return solver->solve();
+}
+
+Solver *Session::last_run() const {
+	return solver;
+}
+
+} /* namespace tabu */
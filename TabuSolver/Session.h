@@ -0,0 +1,63 @@
+#ifndef SESSION_H_
+#define SESSION_H_
+
+#include <string>
+#include "Matrix.h"
+#include "Solver.h"
+#include "ThreadedSolver.h"
+#include "ParallelSolver.h"
+
+namespace tabu {
+
+// parámetros de una llamada a Session::solve
+typedef struct solve_params {
+
+	unsigned int iterations;
+	int diversification_param;
+	unsigned int cells;
+	unsigned int max_machines_cell;
+	int tabu_turns;
+	unsigned int seed;
+	unsigned int candidate_list_period;
+	double time_budget;            // 0: sin límite
+	unsigned int stagnation_limit; // 0: sin límite
+	int target_cost;               // -1: sin objetivo
+	unsigned int diversification_candidates; // 1: una perturbación
+	unsigned int elite_size;       // 0: sin pool de élites
+	unsigned int relink_period;    // 0: sin path relinking
+	long lower_bound;              // cota de la instancia, -1: la calcula el Solver
+} SolveParams;
+
+/*
+ * Sesión de resolución para embeber el solver en un servicio: resuelve
+ * muchas instancias seguidas con un único Solver del backend elegido
+ * ("serial", "threaded" u "opencl"), que se crea en la primera llamada y
+ * después sólo cambia de instancia y parámetros (set_problem,
+ * set_parameters). Así se conservan el contexto, programa, kernels, cola y
+ * buffers OpenCL, el pool de hilos, el pool de soluciones, la lista tabú y
+ * las tablas del DeltaEvaluator, que sólo crecen si la instancia es más
+ * grande. La latencia de solve() no incluye la preparación.
+ *
+ * La Matrix la mantiene quien llama mientras dure solve(). La Solution
+ * retornada pertenece a la sesión y es válida hasta la siguiente llamada;
+ * last_run() da las estadísticas de la última corrida. Una sesión no se
+ * usa desde varios hilos a la vez (una por hilo, como en Batch).
+ */
+class Session {
+public:
+	Session(const std::string &backend, unsigned int n_threads = 0,
+			ClProgram *shared_program = NULL);
+	virtual ~Session();
+	Solution *solve(Matrix *instance, const SolveParams &params);
+	Solver *last_run() const;
+	std::string cl_cache_dir; // si la sesión compila su propio programa
+private:
+	Solver *create_solver(Matrix *instance, const SolveParams &params);
+	std::string backend;
+	unsigned int n_threads;
+	Solver *solver;
+	ClProgram *shared_program;
+};
+
+} /* namespace tabu */
+#endif /* SESSION_H_ */
@@ -6,29 +6,56 @@
  */
 
 #include "SolutionBuilder.h"
+#include <algorithm>
 
 namespace tabu {
 
 SolutionBuilder::SolutionBuilder(unsigned int m) {
 	this->m = m;
+	this->capacity = m;
+	this->allocations = 0;
 }
 
 SolutionBuilder::~SolutionBuilder() {
+	for(unsigned int i=0;i<pool.size();i++)
+		delete pool[i];
 }
 
 Solution *SolutionBuilder::create_solution() {
 
-	Solution *sol = new Solution(m);
+	if(pool.empty()){
+		allocations++;
+		return new Solution(capacity);
+	}
+
+	Solution *sol = pool.back();
+	pool.pop_back();
+	sol->cost = -1;
 	return sol;
 }
 
 Solution *SolutionBuilder::copy_solution(Solution *solution) {
-	Solution *new_sol = solution;
+
+	Solution *new_sol = create_solution();
+	std::copy(solution->cell_vector, solution->cell_vector+m, new_sol->cell_vector);
+	new_sol->cost = solution->cost;
 	return new_sol;
 }
 
+void SolutionBuilder::resize(unsigned int m) {
+
+	if(m > capacity){
+		for(unsigned int i=0;i<pool.size();i++)
+			delete pool[i];
+		pool.clear();
+		capacity = m;
+	}
+	this->m = m;
+}
+
 void SolutionBuilder::destroy_solution(Solution *solution) {
-	delete solution;
+	if(solution != NULL)
+		pool.push_back(solution);
 }
 
 } /* namespace tabu */
@@ -9,9 +9,17 @@
 #define SOLUTIONBUILDER_H_
 
 #include "Solution.h"
+#include <vector>
 
 namespace tabu {
 
+/*
+ * Pool de soluciones de m máquinas: destroy_solution devuelve la solución
+ * al pool y create_solution / copy_solution la reutilizan, así que en
+ * régimen estacionario no hay new/delete. resize() cambia el número de
+ * máquinas; las soluciones del pool se conservan mientras quepan (las
+ * soluciones vivas deben devolverse antes).
+ */
 class SolutionBuilder {
 public:
 	SolutionBuilder(unsigned int m);
@@ -19,8 +27,12 @@ public:
 	Solution *create_solution();
 	Solution *copy_solution(Solution *solution);
 	void destroy_solution(Solution *solution);
+	void resize(unsigned int m);
+	unsigned long allocations;
 private:
 	unsigned int m;
+	unsigned int capacity; // máquinas de cada solución del pool
+	std::vector<Solution *> pool;
 };
 
 } /* namespace tabu */
@@ -6,128 +6,212 @@
  */
 
 #include "Solver.h"
+#include <cstring>
 
 namespace tabu {
 
+// movidas evaluadas en cada paso del path relinking
+static const unsigned int RELINK_CANDIDATES = 16;
+
+const char *stop_reason_name(int reason) {
+	static const char *names[] = { "iterations", "optimum", "target",
+			"time", "stagnation", "bound", "island" };
+	return names[reason];
+}
+
 Solver::Solver(unsigned int max_iterations, int diversification_param,
 		unsigned int n_machines, unsigned int n_parts, unsigned int n_cells,
 		unsigned int max_machines_cell, Matrix *incidence_matrix,
-		int tabu_turns) {
+		int tabu_turns) :
+		lower_bound(-1) {
 
 	this->current_solution = NULL;
 	this->global_best = NULL;
 	this->global_best_cost = -1;
 	this->tabu_list = NULL;
+	this->delta_evaluator = NULL;
+	this->batch_evaluator = NULL;
+	this->fixed_kernel = NULL;
+	this->fixed_size = FIXED_NONE;
+	this->elite_pool = NULL;
+	this->stalled = 0;
+	this->builder = new SolutionBuilder(n_machines);
 	this->n_iterations = 0;
-
-	this->incidence_matrix = incidence_matrix;
-	this->max_iterations = max_iterations;
-	this->diversification_param = diversification_param;
-	this->n_machines = n_machines;
-	this->n_parts = n_parts;
-	this->n_cells = n_cells;
-	this->max_machines_cell = max_machines_cell;
-	this->tabu_turns = tabu_turns;
-	this->tabu_list_max_length = 0;
+	this->seed = time(NULL);
+	this->rand_state = seed;
+	this->verbosity = TRACE_SOLUTIONS;
+	this->n_evaluations = 0;
+	this->elapsed_time = 0;
 	this->iter_cost_time = 0;
 	this->total_cost_time = 0;
+	this->tabu_list_max_length = 0;
 
-	// precómputo de vector
-	parts_machines.assign(n_machines,std::vector<int>());
-	for(unsigned int i=0;i<n_machines;i++){
-		for(unsigned int j=0;j<n_parts;j++){
-			if(incidence_matrix->getMatrix()[i][j] == 1){
-				parts_machines[i].push_back(j);
-			}
-		}
-	}
+	set_parameters(max_iterations, diversification_param, tabu_turns);
+	set_problem(incidence_matrix, n_machines, n_parts, n_cells, max_machines_cell);
+
+	candidate_list_period = 0;
+	time_budget = 0;
+	stagnation_limit = 0;
+	target_cost = -1;
+	stop_reason = STOP_ITERATIONS;
+	checkpoint_period = 1000;
+	resume = false;
+	diversification_candidates = 1;
+	fixed_kernels = true;
+	migration = NULL;
+	island = 0;
+	migration_period = 0;
+	immigrants = 0;
+	elite_size = 0;
+	relink_period = 0;
+	relinks = 0;
+	known_bound = -1;
 }
 
 Solver::~Solver() {
+	builder->destroy_solution(current_solution);
+	builder->destroy_solution(global_best);
+	delete builder;
+	delete delta_evaluator;
+	delete batch_evaluator;
+	delete fixed_kernel;
+	delete elite_pool;
+	delete tabu_list;
 }
 
 void Solver::set_incidence_matrix(Matrix *incidence_matrix) {
 	this->incidence_matrix = incidence_matrix;
 }
 
-long Solver::get_cost(Solution *solution) {
+void Solver::set_problem(Matrix *incidence_matrix, unsigned int n_machines,
+		unsigned int n_parts, unsigned int n_cells,
+		unsigned int max_machines_cell) {
 
-	long cost = 0;
+	// las soluciones vuelven al pool antes de ajustar su tamaño
+	builder->destroy_solution(current_solution);
+	builder->destroy_solution(global_best);
+	current_solution = NULL;
+	global_best = NULL;
+	builder->resize(n_machines);
 
-	std::vector<std::vector<int> > machines_in_cells(n_cells,std::vector<int>());
-	std::vector<std::vector<int> > machines_not_in_cells(n_cells,std::vector<int>());
-	for(unsigned int k=0;k<n_cells;k++){
-		for(unsigned int i=0;i<n_machines;i++){
-			if(solution->cell_vector[i] == (signed int)k)
-				machines_in_cells[k].push_back(i);
-			else
-				machines_not_in_cells[k].push_back(i);
+	this->incidence_matrix = incidence_matrix;
+	this->n_machines = n_machines;
+	this->n_parts = n_parts;
+	this->n_cells = n_cells;
+	this->max_machines_cell = max_machines_cell;
+
+	// partes de cada máquina (CSR) y máquinas de cada parte (CSC)
+	parts_machines = &incidence_matrix->row_index();
+	machines_parts = &incidence_matrix->col_index();
+
+	// assign conserva la capacidad: sólo se asigna memoria si crecen
+	cell_of.assign(n_machines, -1);
+	machines_cell.assign(n_cells, 0);
+	row_costs.assign(n_machines, -1);
+	next_candidate.assign(n_machines+1, 0);
+}
+
+void Solver::set_parameters(unsigned int max_iterations,
+		int diversification_param, int tabu_turns) {
+	this->max_iterations = max_iterations;
+	this->diversification_param = diversification_param;
+	this->tabu_turns = tabu_turns;
+}
+
+void Solver::load_cells(Solution *solution) {
+
+	// celda de cada máquina (-1 fuera de rango) y máquinas por celda
+	std::fill(machines_cell.begin(), machines_cell.end(), 0);
+
+	for(unsigned int i=0;i<n_machines;i++){
+		int k = solution->cell_vector[i];
+		if(k < 0 || k >= (signed int)n_cells){
+			cell_of[i] = -1;
+			continue;
 		}
+		cell_of[i] = k;
+		machines_cell[k]++;
 	}
+}
+
+long Solver::penalty() {
+
+	long cost = 0;
 
 	for(unsigned int k=0;k<n_cells;k++){ // sum k=1...C // celdas
 
 		//------------penalizacion y_ik <= Mmax------------------
 
-		int machines_cell = machines_in_cells[k].size();
-
-		int difference = machines_cell - max_machines_cell;
+		int difference = machines_cell[k] - max_machines_cell;
 		if(difference > 0)
 			cost += (difference)*n_machines*n_parts;
 
 		// -------------------------------------------------------
 	}
 
-	int *parts_cells = new int[n_parts];
-
-	for(unsigned int j=0;j<n_parts;j++){ // todas las partes
-
-		parts_cells[j] = -1;
-
-		for(unsigned int k=0;k<n_cells;k++){ // sum k=1...C // celdas
-
-			int machines_in = machines_in_cells[k].size();
-
-			for(int i_in=0;i_in<machines_in;i_in++){
+	return cost;
+}
 
-				int i_ = machines_in_cells[k][i_in]; // máquina en celda
+long Solver::exceptional_elements() {
 
-				if(incidence_matrix->getMatrix()[i_][j]==1){
-					// parte j en celda k
+	long cost = 0;
+	const Adjacency &machines_of = *machines_parts;
 
-					if(parts_cells[j]==-1)
-						parts_cells[j] = k;
-					else break;
+	for(unsigned int j=0;j<n_parts;j++){ // todas las partes
 
-					int machines_not_in = machines_not_in_cells[k].size();
+		// la primera celda (menor índice) con una máquina de la parte se
+		// queda con ella, el resto de sus máquinas son elementos excepcionales
+		int first = n_cells;
+		int machines_in = 0;
+		for(const int *i=machines_of.begin(j);i!=machines_of.end(j);i++){
+			int k = cell_of[*i];
+			if(k < 0 || k > first)
+				continue;
+			if(k < first){
+				first = k;
+				machines_in = 0;
+			}
+			machines_in++;
+		}
 
-					for(int i_n=0;i_n<machines_not_in;i_n++){ // máquinas no en celda
+		if(first < (signed int)n_cells)
+			cost += machines_of.count(j) - machines_in;
+	}
 
-						int i = machines_not_in_cells[k][i_n]; // máquina no en celda
+	return cost;
+}
 
-						if(incidence_matrix->getMatrix()[i][j]==1){
-							// elemento excepcional (parte celda k también en otra celda)
-							cost++;
-						}
-					}
+long Solver::get_cost(Solution *solution) {
 
-					break; // se continua con otra celda
-				}
-			}
-		}
-	}
+	PROFILE_ADD(profile.counters[PROFILE_COST_EVALUATIONS], 1);
+	if(fixed_kernel != NULL)
+		return fixed_kernel->evaluate(solution->cell_vector);
 
-	delete[] parts_cells;
+	load_cells(solution);
 
-	return cost;
+	return penalty() + exceptional_elements();
 }
 
 void Solver::init() {
 
-	srand ( time(NULL) );
+	rand_state = seed;
 
-	// initial solution
-	current_solution = new Solution(n_machines);
+	// kernel de tamaño fijo si la instancia cabe (antes del primer get_cost)
+	int size = fixed_kernels ? fixed_kernel_size(n_machines, n_parts, n_cells) :
+			FIXED_NONE;
+	if(size != fixed_size){
+		delete fixed_kernel;
+		fixed_kernel = create_fixed_kernel(size);
+		fixed_size = size;
+	}
+	if(fixed_kernel != NULL)
+		fixed_kernel->reset(n_machines, n_parts, n_cells, max_machines_cell,
+				*parts_machines);
+
+	// initial solution (las de una corrida anterior vuelven al pool)
+	builder->destroy_solution(current_solution);
+	builder->destroy_solution(global_best);
+	current_solution = builder->create_solution();
 
 	unsigned int i=0;
 	unsigned int cell = 0;
@@ -142,7 +226,7 @@ void Solver::init() {
 	}
 
 	for(unsigned int i=0;i<n_machines;i++){
-		int j = rand()%n_machines;
+		int j = next_random()%n_machines;
 		int aux = current_solution->cell_vector[i];
 
 		current_solution->cell_vector[i] = current_solution->cell_vector[j];
@@ -150,278 +234,680 @@ void Solver::init() {
 	}
 
 	// set global_best
-	global_best = current_solution->clone();
+	global_best = builder->copy_solution(current_solution);
 
 	// set global_best_cost
 	global_best_cost = get_cost(global_best);
 
 	//tabu list
-	tabu_list = new TabuList(n_machines, tabu_turns);
+	if(tabu_list == NULL)
+		tabu_list = new TabuList(n_machines, tabu_turns);
+	else
+		tabu_list->reset(n_machines, tabu_turns);
+
+	// evaluación incremental de swaps
+	if(delta_evaluator == NULL)
+		delta_evaluator = new DeltaEvaluator(n_machines, n_parts, n_cells,
+				max_machines_cell, *parts_machines);
+	else
+		delta_evaluator->reset(n_machines, n_parts, n_cells,
+				max_machines_cell, *parts_machines);
+
+	// evaluación SIMD de las perturbaciones candidatas
+	if(diversification_candidates > 1){
+		if(batch_evaluator == NULL)
+			batch_evaluator = new BatchEvaluator(n_machines, n_parts, n_cells,
+					max_machines_cell, *machines_parts);
+		else
+			batch_evaluator->reset(n_machines, n_parts, n_cells,
+					max_machines_cell, *machines_parts);
+		candidates.resize((size_t)(BatchEvaluator::LANES+1)*n_machines);
+	}
+
+	// pool de élites para el path relinking, parte con la solución inicial
+	if(elite_size > 0){
+		if(elite_pool == NULL)
+			elite_pool = new ElitePool(elite_size, n_machines, n_cells, n_machines/10);
+		else
+			elite_pool->reset(elite_size, n_machines, n_cells, n_machines/10);
+		elite_pool->insert(global_best->cell_vector, global_best_cost);
+	} else {
+		delete elite_pool;
+		elite_pool = NULL;
+	}
 
 }
 
 int Solver::local_search(){
 
-	// moves : vector permutation
+	switch(fixed_size){
+	case FIXED_16x32x4:
+		return local_search_with(*static_cast<FixedKernel16x32x4 *>(fixed_kernel));
+	case FIXED_32x64x8:
+		return local_search_with(*static_cast<FixedKernel32x64x8 *>(fixed_kernel));
+	case FIXED_64x128x16:
+		return local_search_with(*static_cast<FixedKernel64x128x16 *>(fixed_kernel));
+	default:
+		return local_search_with(*delta_evaluator);
+	}
+}
+
+template<class Evaluator>
+int Solver::local_search_with(Evaluator &evaluator){
+
+	// moves : vector permutation, swap - evaluación - deshacer sobre la
+	// solución actual, sin copias
+
+	double start = wall_time();
 
 	Solution *initial_solution = current_solution;
+	int *cells = initial_solution->cell_vector;
 
-	int costs[n_machines];
-	for(unsigned int i=0;i<n_machines;i++)
-		costs[i] = -1;
+	std::fill(row_costs.begin(), row_costs.end(), -1);
+	int *costs = &row_costs[0];
 
 	int best_cost = -1;
-	Solution *local_best = NULL;
+	long local_best_cost = -1;
+	unsigned int best_i = 0;
+	unsigned int best_j = 0;
 
-	for(unsigned int i=0;i<n_machines;i++){
-		for(unsigned int j=i+1;j<n_machines;j++){
+	long current_cost = evaluator.load(initial_solution);
+	uint64_t current_hash = tabu_list->hash(cells);
 
-			Solution *sol = initial_solution->clone();
-			bool delete_sol = true;
+	// lista de candidatos: sólo pares con al menos una máquina que genera
+	// elementos excepcionales o está en una celda sobre el máximo; cada
+	// candidate_list_period iteraciones se recorre el vecindario completo
+	bool restricted = candidate_list_period > 0 &&
+			n_iterations % candidate_list_period != 0;
+	unsigned int *next = &next_candidate[0];
+	next[n_machines] = n_machines;
+	for(int x=n_machines-1;x>=0;x--)
+		next[x] = (!restricted || evaluator.candidate(x)) ? x : next[x+1];
 
-			sol->exchange(i,j);
+	unsigned long evaluated = 0;
 
-			int cost = get_cost(sol);
+	for(unsigned int i=0;i<n_machines;i++){
+		bool all_j = next[i] == i;
+		for(unsigned int j = all_j ? i+1 : next[i+1]; j<n_machines;
+				j = all_j ? j+1 : next[j+1]){
+
+			evaluated++;
+
+			int cost = current_cost;
+			uint64_t hash = current_hash;
+			bool moved = initial_solution->exchange(i,j);
+			if(moved){
+				hash = tabu_list->swap_hash(current_hash, cells, i, j);
+				cost += evaluator.swap_delta(i,j);
+			}
 
 			if(costs[i] < 0 || cost < costs[i])
 				costs[i] = cost;
 
 			if(best_cost < 0 || ((cost < best_cost
-					&& !tabu_list->is_tabu(sol)
+					&& !is_tabu(cells, hash)
 					)
-				&& rand()%100 < 90)
+				&& next_random()%100 < 90)
 			){
-				if(local_best != NULL)
-					delete local_best;
-
-				local_best = sol;
+				best_i = i;
+				best_j = j;
+				local_best_cost = cost;
 				best_cost = costs[i];
-				delete_sol = false;
 			}
 
 			if(cost < global_best_cost){
-				delete global_best;
-				global_best = sol->clone();
+				builder->destroy_solution(global_best);
+				global_best = builder->copy_solution(initial_solution);
+				global_best->cost = cost;
 				global_best_cost = cost;
-				delete_sol = false;
 			}
 
-			if(delete_sol == true)
-				delete sol;
+			if(moved)
+				initial_solution->exchange(i,j); // deshacer
 		}
 	}
 
-	delete current_solution;
-	current_solution = local_best;
+	if(best_cost >= 0){
+		initial_solution->exchange(best_i,best_j);
+		initial_solution->cost = local_best_cost;
+	}
 	tabu_list->add_tabu(current_solution);
 
+	n_evaluations += evaluated;
+	iter_cost_time += (wall_time() - start)*1e9;
+
 	return 0;
 }
 
-void Solver::global_search() {
+void Solver::perturb(int *cells) {
 
 	int i = 0;
 	while(i<diversification_param){
 
-		int j = rand()%n_machines;
-		int k = rand()%n_machines;
+		int j = next_random()%n_machines;
+		int k = next_random()%n_machines;
 		int i_ = i%n_machines;
 
 		if(j==k)
 			continue;
 
 		// replace items
-		int aux = current_solution->cell_vector[i_];
-		current_solution->cell_vector[i_] = current_solution->cell_vector[j];
-		current_solution->cell_vector[j] = aux;
+		int aux = cells[i_];
+		cells[i_] = cells[j];
+		cells[j] = aux;
 		i++;
 	}
 
 	i = 0;
 	while(i<(diversification_param/2)+1){
 
-		int j = rand()%n_machines;
+		int j = next_random()%n_machines;
 
 		// replace items
-		int k = rand()%n_cells;
-		current_solution->cell_vector[j] = k;
+		int k = next_random()%n_cells;
+		cells[j] = k;
 		i++;
 	}
+}
 
-	int cost = get_cost(current_solution);
-	current_solution->cost = cost;
-	if(cost < global_best_cost){
-		delete global_best;
-		global_best = current_solution->clone();
-		global_best_cost = cost;
-	}
+bool Solver::immigrate() {
 
+	// élite de la isla vecina, sólo si mejora la mejor global de esta isla
+	long cost;
+	immigrant.resize(n_machines);
+	if(!migration->receive(island, global_best_cost, &immigrant[0], cost))
+		return false;
+
+	std::copy(immigrant.begin(), immigrant.end(), current_solution->cell_vector);
+	current_solution->cost = cost;
+	builder->destroy_solution(global_best);
+	global_best = builder->copy_solution(current_solution);
+	global_best_cost = cost;
+	immigrants++;
+	return true;
 }
 
-Solution *Solver::solve(){
+bool Solver::path_relinking() {
 
-	std::ofstream out_file (file_out.c_str());
-	if (!out_file.is_open()) {
-		std::cout << "Unable to open file";
+	// dos élites al azar: se camina desde a hacia la guía b
+	unsigned int n_elites = elite_pool->size();
+	if(n_elites < 2)
+		return false;
+	unsigned int a = next_random()%n_elites;
+	unsigned int b = next_random()%(n_elites-1);
+	if(b >= a)
+		b++;
+
+	const int *start = elite_pool->cells(a);
+	const int *guide = elite_pool->cells(b);
+	relink_diff.clear();
+	for(unsigned int i=0;i<n_machines;i++){
+		if(start[i] != guide[i])
+			relink_diff.push_back(i);
 	}
+	if(relink_diff.size() < 2) // sin soluciones intermedias
+		return false;
+
+	int *cells = current_solution->cell_vector;
+	std::copy(start, start+n_machines, cells);
+	relink_best.resize(n_machines);
+	long best_cost = -1;
+	delta_evaluator->load(current_solution);
+
+	// cada paso deja una máquina i más en su celda de la guía; si otra
+	// máquina j que difiere está en esa celda, se intercambian (swap) para
+	// no cambiar el tamaño de las celdas. Se aplica el mejor de hasta
+	// RELINK_CANDIDATES pasos y se guarda la mejor solución intermedia.
+	// Los pasos se evalúan y aplican en el DeltaEvaluator, en O(grado).
+	while(relink_diff.size() > 1){
+
+		unsigned int n_diff = relink_diff.size();
+		unsigned int n_candidates = std::min(n_diff, RELINK_CANDIDATES);
+		if(n_diff > n_candidates){
+			for(unsigned int c=0;c<n_candidates;c++)
+				std::swap(relink_diff[c], relink_diff[c + next_random()%(n_diff-c)]);
+		}
 
-	init();
-	// ------ print solution -------
-	print_solution(current_solution);
-	//print_file_solution(0, current_solution, out_file);
-	// ------ print solution -------
+		long step_cost = -1;
+		unsigned int step_i = 0;
+		unsigned int step_j = n_machines;
+		for(unsigned int c=0;c<n_candidates;c++){
+			unsigned int i = relink_diff[c];
+
+			// pareja: una que difiere en la celda que i necesita, de
+			// preferencia una que a su vez necesita la celda de i
+			unsigned int j = n_machines;
+			for(unsigned int d=0;d<n_diff;d++){
+				unsigned int x = relink_diff[d];
+				if(x != i && cells[x] == guide[i]){
+					j = x;
+					if(guide[x] == cells[i])
+						break;
+				}
+			}
 
-   clock_t start, end, total;
+			long cost = delta_evaluator->cost + (j < n_machines ?
+					delta_evaluator->swap_delta(i, j) :
+					delta_evaluator->move_delta(i, guide[i]));
 
-	start = clock();
+			if(step_cost < 0 || cost < step_cost){
+				step_cost = cost;
+				step_i = i;
+				step_j = j;
+			}
+		}
 
+		int cell_i = cells[step_i];
+		cells[step_i] = guide[step_i];
+		delta_evaluator->move(step_i, guide[step_i]);
+		if(step_j < n_machines){
+			cells[step_j] = cell_i;
+			delta_evaluator->move(step_j, cell_i);
+		}
 
-	for(unsigned int i=0;i<max_iterations;i++){
+		// fuera de la lista las máquinas que ya coinciden con la guía
+		for(unsigned int d=0;d<relink_diff.size();){
+			unsigned int x = relink_diff[d];
+			if(cells[x] == guide[x]){
+				relink_diff[d] = relink_diff.back();
+				relink_diff.pop_back();
+			} else
+				d++;
+		}
 
-		iter_cost_time = 0;
+		if(!relink_diff.empty() && (best_cost < 0 || step_cost < best_cost)){
+			best_cost = step_cost;
+			std::copy(cells, cells+n_machines, relink_best.begin());
+		}
+	}
 
-		std::cout << "----- iteration "<< i << " ------" << std::endl;
+	// sin intermedias (un swap llegó a la guía) se sigue desde la guía
+	if(best_cost >= 0)
+		std::copy(relink_best.begin(), relink_best.end(), cells);
+	else
+		best_cost = get_cost(current_solution);
+
+	current_solution->cost = best_cost;
+	if(best_cost < global_best_cost){
+		builder->destroy_solution(global_best);
+		global_best = builder->copy_solution(current_solution);
+		global_best_cost = best_cost;
+	}
+	elite_pool->insert(cells, best_cost);
+	relinks++;
+	return true;
+}
 
-		local_search();
+void Solver::global_search() {
 
-		// ------ print solution -------
-		std::cout << "local search  ";
-		print_solution(current_solution);
-		print_file_solution(i, current_solution, out_file);
-		// ------ print solution -------
+	// iteración de migración: la élite recibida reemplaza a la perturbación
+	if(migration != NULL && migration_period > 0 &&
+			n_iterations % migration_period == 0 && n_iterations > 0 &&
+			immigrate())
+		return;
+
+	// estancamiento: path relinking entre dos élites en vez de perturbar
+	if(elite_pool != NULL && relink_period > 0 && stalled > 0 &&
+			stalled % relink_period == 0 && path_relinking())
+		return;
+
+	if(diversification_candidates <= 1){
+		perturb(current_solution->cell_vector);
+
+		int cost = get_cost(current_solution);
+		current_solution->cost = cost;
+		if(cost < global_best_cost){
+			builder->destroy_solution(global_best);
+			global_best = builder->copy_solution(current_solution);
+			global_best_cost = cost;
+		}
+		return;
+	}
 
-		global_search();
+	// diversification_candidates perturbaciones de la solución actual,
+	// evaluadas de a LANES con el BatchEvaluator; se queda la de menor costo
+	// (la primera en caso de empate)
+	const unsigned int lanes = BatchEvaluator::LANES;
+	long costs[BatchEvaluator::LANES];
+	long best_cost = -1;
+
+	// tras las LANES candidatas va una copia de la solución de partida
+	int *origin = &candidates[(size_t)lanes*n_machines];
+	std::copy(current_solution->cell_vector,
+			current_solution->cell_vector+n_machines, origin);
+
+	for(unsigned int c=0;c<diversification_candidates;c+=lanes){
+		unsigned int n = std::min(lanes, diversification_candidates-c);
+		for(unsigned int l=0;l<n;l++){
+			int *cells = &candidates[(size_t)l*n_machines];
+			std::copy(origin, origin+n_machines, cells);
+			perturb(cells);
+			batch_evaluator->set(l, cells);
+		}
+		batch_evaluator->evaluate(n, costs);
+		PROFILE_ADD(profile.counters[PROFILE_COST_EVALUATIONS], n);
+
+		for(unsigned int l=0;l<n;l++){
+			if(best_cost < 0 || costs[l] < best_cost){
+				best_cost = costs[l];
+				std::copy(&candidates[(size_t)l*n_machines],
+						&candidates[(size_t)(l+1)*n_machines],
+						current_solution->cell_vector);
+			}
+		}
+	}
 
-		// ------ print solution -------
-		std::cout << "global search ";
-		print_solution(current_solution);
-		//print_file_solution(i, current_solution, out_file);
-		// ------ print solution -------
+	current_solution->cost = best_cost;
+	if(best_cost < global_best_cost){
+		builder->destroy_solution(global_best);
+		global_best = builder->copy_solution(current_solution);
+		global_best_cost = best_cost;
+	}
+}
 
-		tabu_list->update_tabu();
+Solution *Solver::solve(){
 
-	    total_cost_time += iter_cost_time;
+	// --resume: el checkpoint se valida antes de preparar nada
+	CheckpointState resume_state;
+	if(resume){
+		std::string error;
+		if(!read_checkpoint(checkpoint_file.c_str(), resume_state, error) ||
+				!check_state(resume_state, error)){
+			fprintf(stderr, "%s\n", error.c_str());
+			return NULL;
+		}
+	}
 
-		if(global_best_cost == 0)
-			break;
+	// serie para gnuplot (-O):
+	//plot "out.txt" using 1:2 title "óptimos locales" with lines,"out.txt" using 1:3 title "óptimo global" with lines
+	FILE *series = NULL;
+	if(!file_out.empty() && (series = fopen(file_out.c_str(), "w")) == NULL)
+		fprintf(stderr, "%s: no se pudo abrir el archivo\n", file_out.c_str());
+
+	FILE *out = stdout;
+	if(!trace_file.empty() && verbosity > TRACE_NONE &&
+			(out = fopen(trace_file.c_str(), "w")) == NULL){
+		fprintf(stderr, "%s: no se pudo abrir el archivo\n", trace_file.c_str());
+		out = stdout;
 	}
 
-	end = clock();
-	total = end - start;
+	TraceSink trace(verbosity, n_machines, verbosity > TRACE_NONE ? out : NULL,
+			series);
+
+	double wall_start = wall_time();
+	n_iterations = 0;
+	n_evaluations = 0;
+	total_cost_time = 0;
+	improvements.clear();
+	profile.clear();
+	immigrants = 0;
+	relinks = 0;
+	stalled = 0;
+	long published_cost = -1;
+	unsigned long allocations = builder->allocations;
+
+	unsigned int last_improvement = 0;
+
+	// la cota la da quien comparte la instancia entre solvers (Portfolio,
+	// Batch); un Solver solo la calcula en paralelo con la búsqueda
+	lower_bound.store(known_bound);
+	std::thread bound_thread;
+	if(known_bound < 0)
+		bound_thread = std::thread([this]() {
+			lower_bound.store(exceptional_lower_bound(*machines_parts, n_machines,
+					n_parts, n_cells, max_machines_cell), std::memory_order_release);
+		});
+
+	{
+		PROFILE_SCOPE(profile, PROFILE_INIT);
+		init();
+	}
+	if(resume){
+		restore_state(resume_state, last_improvement);
+		stalled = n_iterations - last_improvement;
+		wall_start -= resume_state.header.elapsed_time; // time_budget es del total
+	}
+	improvements.push_back(std::make_pair(wall_time() - wall_start, global_best_cost));
+	trace.solution(TRACE_INITIAL, n_iterations, global_best_cost, global_best_cost,
+			current_solution->cell_vector);
 
-    printf("\nTotal OpenCL Kernel time in milliseconds = %0.3f ms\n", (total_cost_time / 1000000.0) );
-    printf("Total CPU time in milliseconds = %0.3f ms\n", total /1000.0);
+	CheckpointWriter *checkpoint = NULL;
+	CheckpointState checkpoint_state;
+	if(!checkpoint_file.empty())
+		checkpoint = new CheckpointWriter(checkpoint_file);
 
-	return global_best;
-}
+   clock_t start, end, total;
 
-void Solver::print_solution(Solution *sol){
-	for(unsigned int j=0;j<n_machines;j++)
-		std::cout<< sol->cell_vector[j] << " ";
-	std::cout<< "  cost: "<< sol->cost << "|" << get_cost(sol);
-	std::cout<< "  global best: "<< global_best_cost;
-	std::cout << std::endl;
-}
+	start = clock();
 
-bool Solver::es_factible(Solution *solution) {
 
-	int cost = 0;
+	stop_reason = STOP_ITERATIONS;
 
-	std::vector<std::vector<int> > machines_in_cells(n_cells,std::vector<int>());
-	std::vector<std::vector<int> > machines_not_in_cells(n_cells,std::vector<int>());
-	for(unsigned int k=0;k<n_cells;k++){
-		for(unsigned int i=0;i<n_machines;i++){
-			if(solution->cell_vector[i] == (signed int)k)
-				machines_in_cells[k].push_back(i);
-			else
-				machines_not_in_cells[k].push_back(i);
-		}
-	}
+	for(unsigned int i=n_iterations;i<max_iterations;i++){
 
-	for(unsigned int k=0;k<n_cells;k++){ // sum k=1...C // celdas
+		if(should_stop(wall_start, last_improvement))
+			break;
 
-		//------------penalizacion y_ik <= Mmax------------------
+		iter_cost_time = 0;
 
-		int machines_cell = machines_in_cells[k].size();
-		int difference = machines_cell - max_machines_cell;
-		if(difference > 0)
-			cost += difference;
-	}
+		{
+			PROFILE_SCOPE(profile, PROFILE_LOCAL_SEARCH);
+			local_search();
+		}
 
-	bool ret = false;
-	if(cost == 0)
-		ret = true;
+		// cada óptimo local es candidato al pool de élites
+		if(elite_pool != NULL)
+			elite_pool->insert(current_solution->cell_vector, current_solution->cost);
 
-	return ret;
+		trace.solution(TRACE_LOCAL, i, current_solution->cost, global_best_cost,
+				current_solution->cell_vector);
 
-}
+		{
+			PROFILE_SCOPE(profile, PROFILE_GLOBAL_SEARCH);
+			global_search();
+		}
 
-int Solver::get_costo_real(Solution *solution) {
+		trace.solution(TRACE_GLOBAL, i, current_solution->cost, global_best_cost,
+				current_solution->cell_vector);
+
+		{
+			PROFILE_SCOPE(profile, PROFILE_UPDATE_TABU);
+			tabu_list->update_tabu();
+		}
+		n_iterations = i+1;
+
+		if(global_best_cost < improvements.back().second){
+			improvements.push_back(std::make_pair(wall_time() - wall_start, global_best_cost));
+			last_improvement = n_iterations;
+			if(elite_pool != NULL)
+				elite_pool->insert(global_best->cell_vector, global_best_cost);
+		}
+		stalled = n_iterations - last_improvement;
+
+		// isla: se publica la mejor global si cambió desde la última vez
+		if(migration != NULL && migration_period > 0 &&
+				n_iterations % migration_period == 0 &&
+				(published_cost < 0 || global_best_cost < published_cost)){
+			migration->publish(island, global_best->cell_vector, global_best_cost);
+			published_cost = global_best_cost;
+		}
 
-	int cost = 0;
+	    total_cost_time += iter_cost_time;
 
-	std::vector<std::vector<int> > machines_in_cells(n_cells,std::vector<int>());
-	std::vector<std::vector<int> > machines_not_in_cells(n_cells,std::vector<int>());
-	for(unsigned int k=0;k<n_cells;k++){
-		for(unsigned int i=0;i<n_machines;i++){
-			if(solution->cell_vector[i] == (signed int)k)
-				machines_in_cells[k].push_back(i);
-			else
-				machines_not_in_cells[k].push_back(i);
+		if(checkpoint != NULL && checkpoint_period > 0 &&
+				n_iterations % checkpoint_period == 0){
+			save_state(checkpoint_state, last_improvement, wall_time() - wall_start);
+			checkpoint->submit(checkpoint_state);
 		}
 	}
-	int *parts_cells = new int[n_parts];
 
-	for(unsigned int j=0;j<n_parts;j++){ // todas las partes
+	// el último estado permite extender la corrida con más iteraciones
+	if(checkpoint != NULL){
+		save_state(checkpoint_state, last_improvement, wall_time() - wall_start);
+		checkpoint->submit(checkpoint_state);
+		delete checkpoint;
+	}
 
-		parts_cells[j] = -1;
+	if(bound_thread.joinable())
+		bound_thread.join();
 
-		for(unsigned int k=0;k<n_cells;k++){ // sum k=1...C // celdas
+	// óptimo u objetivo alcanzado justo en la última iteración
+	if(stop_reason == STOP_ITERATIONS && global_best_cost == 0)
+		stop_reason = STOP_OPTIMUM;
+	else if(stop_reason == STOP_ITERATIONS && global_best_cost <= lower_bound.load())
+		stop_reason = STOP_BOUND;
+	else if(stop_reason == STOP_ITERATIONS && target_cost >= 0 &&
+			global_best_cost <= target_cost)
+		stop_reason = STOP_TARGET;
 
-			int machines_in = machines_in_cells[k].size();
+	// las demás islas terminan en su siguiente iteración
+	if(migration != NULL && (stop_reason == STOP_OPTIMUM ||
+			stop_reason == STOP_BOUND || stop_reason == STOP_TARGET))
+		migration->finish();
 
-			for(int i_in=0;i_in<machines_in;i_in++){
+	end = clock();
+	total = end - start;
+	elapsed_time = wall_time() - wall_start;
+	profile.counters[PROFILE_SWAP_EVALUATIONS] = n_evaluations;
+	profile.counters[PROFILE_ALLOCATIONS] = builder->allocations - allocations;
 
-				int i_ = machines_in_cells[k][i_in]; // máquina en celda
+	trace.summary(total_cost_time / 1000000.0, total / 1000.0,
+			stop_reason_name(stop_reason), n_iterations);
+	trace.close();
 
-				if(incidence_matrix->getMatrix()[i_][j]==1){
-					// parte j en celda k
+	if(series != NULL)
+		fclose(series);
+	if(out != stdout)
+		fclose(out);
 
-					if(parts_cells[j]==-1)
-						parts_cells[j] = k;
-					else break;
+	return global_best;
+}
 
-					int machines_not_in = machines_not_in_cells[k].size();
+bool Solver::should_stop(double wall_start, unsigned int last_improvement) {
+
+	if(global_best_cost == 0)
+		stop_reason = STOP_OPTIMUM;
+	else if(global_best_cost <= lower_bound.load(std::memory_order_acquire))
+		stop_reason = STOP_BOUND;
+	else if(target_cost >= 0 && global_best_cost <= target_cost)
+		stop_reason = STOP_TARGET;
+	else if(time_budget > 0 && wall_time() - wall_start >= time_budget)
+		stop_reason = STOP_TIME;
+	else if(stagnation_limit > 0 && n_iterations - last_improvement >= stagnation_limit)
+		stop_reason = STOP_STAGNATION;
+	else if(migration != NULL && migration->finished())
+		stop_reason = STOP_ISLAND;
+	else
+		return false;
+
+	return true;
+}
 
-					for(int i_n=0;i_n<machines_not_in;i_n++){ // máquinas no en celda
+void Solver::save_state(CheckpointState &state, unsigned int last_improvement,
+		double elapsed) {
+
+	CheckpointHeader &h = state.header;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, CHECKPOINT_MAGIC, 8);
+	h.version = CHECKPOINT_VERSION;
+	h.byte_order = CHECKPOINT_BYTE_ORDER;
+	h.header_size = sizeof(h);
+
+	h.n_machines = n_machines;
+	h.n_parts = n_parts;
+	h.n_cells = n_cells;
+	h.max_machines_cell = max_machines_cell;
+	h.tabu_turns = tabu_turns;
+	h.diversification_param = diversification_param;
+	h.candidate_list_period = candidate_list_period;
+	h.diversification_candidates = diversification_candidates;
+	h.elite_size = elite_size;
+	h.relink_period = relink_period;
+	h.nnz = machines_parts->offsets[n_parts];
+	h.seed = seed;
+
+	h.n_iterations = n_iterations;
+	h.last_improvement = last_improvement;
+	h.rand_state = rand_state;
+	h.current_cost = current_solution->cost;
+	h.global_best_cost = global_best_cost;
+	h.tabu_turn = tabu_list->current_turn();
+	h.tabu_size = tabu_list->entries();
+	h.elite_count = elite_pool != NULL ? elite_pool->size() : 0;
+	h.n_evaluations = n_evaluations;
+	h.elapsed_time = elapsed;
+
+	// el buffer se reutiliza entre checkpoints (submit lo intercambia)
+	state.payload.resize(2*n_machines + (h.tabu_size + h.elite_count)*(1+n_machines));
+	int32_t *p = state.payload.data();
+	std::copy(current_solution->cell_vector, current_solution->cell_vector+n_machines, p);
+	std::copy(global_best->cell_vector, global_best->cell_vector+n_machines, p+n_machines);
+	tabu_list->save(p+2*n_machines);
+	if(elite_pool != NULL)
+		elite_pool->save(p + 2*n_machines + h.tabu_size*(1+n_machines));
+}
 
-						int i = machines_not_in_cells[k][i_n]; // máquina no en celda
+bool Solver::check_state(const CheckpointState &state, std::string &error) {
+
+	const CheckpointHeader &h = state.header;
+	if(h.n_machines != n_machines || h.n_parts != n_parts ||
+			h.nnz != (uint64_t)machines_parts->offsets[n_parts])
+		error = checkpoint_file + ": el checkpoint es de otra instancia";
+	else if(h.n_cells != n_cells || h.max_machines_cell != max_machines_cell ||
+			h.tabu_turns != tabu_turns ||
+			h.diversification_param != diversification_param ||
+			h.candidate_list_period != candidate_list_period ||
+			h.diversification_candidates != diversification_candidates ||
+			h.elite_size != elite_size || h.relink_period != relink_period)
+		error = checkpoint_file + ": parámetros distintos a los del checkpoint";
+	else if(h.tabu_size > (tabu_turns > 0 ? (unsigned int)tabu_turns+1 : 0))
+		error = checkpoint_file + ": lista tabú inválida";
+	else if(h.elite_count > elite_size)
+		error = checkpoint_file + ": pool de élites inválido";
+	else
+		return true;
+
+	return false;
+}
 
-						if(incidence_matrix->getMatrix()[i][j]==1){
-							// elemento excepcional (parte celda k también en otra celda)
-							cost++;
-						}
-					}
+void Solver::restore_state(const CheckpointState &state, unsigned int &last_improvement) {
 
-					break; // se continua con otra parte
-				}
-			}
-		}
-	}
+	const CheckpointHeader &h = state.header;
+	const int32_t *p = state.payload.data();
 
-	delete[] parts_cells;
+	seed = h.seed;
+	n_iterations = h.n_iterations;
+	last_improvement = h.last_improvement;
+	rand_state = h.rand_state;
+	n_evaluations = h.n_evaluations;
 
-	return cost;
+	std::copy(p, p+n_machines, current_solution->cell_vector);
+	current_solution->cost = h.current_cost;
+	std::copy(p+n_machines, p+2*n_machines, global_best->cell_vector);
+	global_best->cost = h.global_best_cost;
+	global_best_cost = h.global_best_cost;
 
+	tabu_list->restore(h.tabu_turn, h.tabu_size, p+2*n_machines);
+	if(elite_pool != NULL)
+		elite_pool->restore(h.elite_count, p + 2*n_machines + h.tabu_size*(1+n_machines));
 }
 
-void Solver::print_file_solution(unsigned int iteration, Solution* sol, std::ofstream &file) {
+int Solver::next_random() {
+	return rand_r(&rand_state);
+}
 
-	// gnuplot
-	//plot "out.txt" using 1:2 title "óptimos locales" with lines,"out.txt" using 1:3 title "óptimo global" with lines
+bool Solver::es_factible(Solution *solution) {
+
+	load_cells(solution);
+
+	return penalty() == 0;
+}
+
+int Solver::get_costo_real(Solution *solution) {
+
+	load_cells(solution);
 
-	if(file.is_open())
-		file << iteration << " " << get_cost(sol) << " " << global_best_cost << "\n";
+	return exceptional_elements();
 }
 
 } /* namespace tabu */
@@ -11,15 +11,41 @@
 #include "Solution.h"
 #include "Matrix.h"
 #include "TabuList.h"
+#include "DeltaEvaluator.h"
+#include "SolutionBuilder.h"
+#include "Timer.h"
+#include "Trace.h"
+#include "Profile.h"
+#include "Checkpoint.h"
+#include "LowerBound.h"
+#include "BatchEvaluator.h"
+#include "FixedKernel.h"
+#include "Migration.h"
+#include "ElitePool.h"
+#include <atomic>
 #include <climits>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 #ifndef SOLVER_H_
 #define SOLVER_H_
 
 namespace tabu {
 
+// motivo de término de solve()
+enum StopReason {
+	STOP_ITERATIONS,  // max_iterations
+	STOP_OPTIMUM,     // costo 0
+	STOP_TARGET,      // target_cost alcanzado
+	STOP_TIME,        // time_budget agotado
+	STOP_STAGNATION,  // stagnation_limit iteraciones sin mejora global
+	STOP_BOUND,       // costo igual a la cota inferior: óptimo probado
+	STOP_ISLAND       // otra isla llegó al óptimo o al objetivo
+};
+
+const char *stop_reason_name(int reason);
+
 class Solver {
 public:
 	Solver(unsigned int max_iterations, int diversification_param,
@@ -28,6 +54,11 @@ public:
 			int tabu_turns);
 	virtual ~Solver();
 	void set_incidence_matrix(Matrix *incidence_matrix);
+	void set_problem(Matrix *incidence_matrix, unsigned int n_machines,
+			unsigned int n_parts, unsigned int n_cells,
+			unsigned int max_machines_cell);
+	void set_parameters(unsigned int max_iterations, int diversification_param,
+			int tabu_turns);
 	bool es_factible(Solution *solution);
 	int get_costo_real(Solution *solution);
 	Solution *solve();
@@ -36,12 +67,47 @@ public:
 	Solution *global_best;
 	int global_best_cost;
 	std::string file_out;
+	unsigned int seed;
+	int verbosity;          // TraceLevel
+	std::string trace_file; // vacío: stdout
+	unsigned int n_iterations;
+	unsigned long n_evaluations;
+	unsigned int candidate_list_period; // 0: vecindario completo siempre
+	double elapsed_time;
+	std::vector<std::pair<double,int> > improvements; // (segundos, costo) de cada mejora global
+	Profile profile;
+	double time_budget;            // segundos de pared, 0: sin límite
+	unsigned int stagnation_limit; // iteraciones sin mejora global, 0: sin límite
+	int target_cost;               // -1: sin objetivo
+	int stop_reason;               // StopReason de la última corrida
+	std::string checkpoint_file;   // vacío: sin checkpoints
+	unsigned int checkpoint_period; // iteraciones entre checkpoints, 0: sólo al terminar
+	bool resume;                   // continuar desde checkpoint_file
+	std::atomic<long> lower_bound; // -1 mientras se calcula
+	long known_bound;              // cota ya calculada para esta instancia, -1: la calcula solve()
+	unsigned int diversification_candidates; // perturbaciones por global_search, 1: una
+	bool fixed_kernels;            // false: siempre el DeltaEvaluator genérico
+	Migration *migration;          // modo isla del Portfolio, NULL: sin migración
+	unsigned int island;           // índice de esta isla en migration
+	unsigned int migration_period; // iteraciones entre migraciones
+	unsigned int immigrants;       // élites adoptadas en la última corrida
+	unsigned int elite_size;       // soluciones del pool de élites, 0: sin pool
+	unsigned int relink_period;    // iteraciones sin mejora entre path relinking, 0: nunca
+	unsigned int relinks;          // path relinking hechos en la última corrida
 
 protected:
 	TabuList *tabu_list;
+	DeltaEvaluator *delta_evaluator;
+	BatchEvaluator *batch_evaluator; // sólo con diversification_candidates > 1
+	FixedKernelBase *fixed_kernel;   // NULL si la instancia no cabe en ninguno
+	ElitePool *elite_pool;           // sólo con elite_size > 0
+	unsigned int stalled;            // iteraciones desde la última mejora global
+	int fixed_size;                  // FixedSize de fixed_kernel
+	SolutionBuilder *builder;
 	int tabu_turns;
 	int tabu_list_max_length;
-	unsigned int n_iterations;
+	unsigned int rand_state;
+	int next_random();
 	int diversification_param;
 	unsigned int max_iterations;
 	unsigned int n_machines;
@@ -49,15 +115,40 @@ protected:
 	unsigned int max_machines_cell;
 	virtual void init();
 	virtual int local_search();
+	template<class Evaluator> int local_search_with(Evaluator &evaluator);
 	void global_search();
+	void perturb(int *cells);
+	bool immigrate();
+	bool path_relinking();
+	bool should_stop(double wall_start, unsigned int last_improvement);
+	void save_state(CheckpointState &state, unsigned int last_improvement,
+			double elapsed);
+	bool check_state(const CheckpointState &state, std::string &error);
+	void restore_state(const CheckpointState &state, unsigned int &last_improvement);
 	unsigned int n_cells;
 	virtual long get_cost(Solution *solution);
-	void print_solution(Solution *sol);
-	void print_file_solution(unsigned int iteration, Solution *sol, std::ofstream &file);
+	bool is_tabu(const int *cells, uint64_t hash);
 	double iter_cost_time;
 	double total_cost_time;
-	std::vector<std::vector<int> > parts_machines;
+	const Adjacency *parts_machines; // compartido, de Matrix
+	void load_cells(Solution *solution);
+	long penalty();
+	long exceptional_elements();
+	const Adjacency *machines_parts; // máquinas de cada parte, de Matrix
+	std::vector<int> cell_of;
+	std::vector<int> machines_cell;
+	std::vector<int> row_costs;
+	std::vector<unsigned int> next_candidate; // siguiente máquina candidata >= x
+	std::vector<int> candidates;              // perturbaciones de global_search
+	std::vector<int> immigrant;               // élite recibida de otra isla
+	std::vector<int> relink_best;             // mejor solución intermedia
+	std::vector<unsigned int> relink_diff;    // máquinas que difieren de la guía
 };
 
+inline bool Solver::is_tabu(const int *cells, uint64_t hash) {
+	PROFILE_ADD(profile.counters[PROFILE_TABU_LOOKUPS], 1);
+	return tabu_list->is_tabu(cells, hash);
+}
+
 } /* namespace tabu */
 #endif /* SOLVER_H_ */
@@ -6,64 +6,133 @@
  */
 
 #include "TabuList.h"
+#include <cstring>
+#include <algorithm>
 
 namespace tabu {
 
 TabuList::TabuList(unsigned int n_machines, int tabu_turns) {
-	this->n_machines = n_machines;
-	this->tabu_turns = tabu_turns;
+	reset(n_machines, tabu_turns);
 }
 
 TabuList::~TabuList() {
 
 }
 
-bool TabuList::is_tabu(Solution *sol) {
+void TabuList::reset(unsigned int n_machines, int tabu_turns) {
+	this->n_machines = n_machines;
+	this->tabu_turns = tabu_turns;
+	this->capacity = tabu_turns > 0 ? tabu_turns+1 : 0;
+	this->head = 0;
+	this->size = 0;
+	this->turn = 0;
+
+	arena.assign(capacity*n_machines, 0);
+	hashes.assign(capacity, 0);
+	expires.assign(capacity, 0);
+	next.assign(capacity, -1);
+
+	unsigned int n_buckets = 1;
+	while(n_buckets < 2*capacity)
+		n_buckets <<= 1;
+	buckets.assign(n_buckets, -1);
+	bucket_mask = n_buckets-1;
+}
 
-	bool tabu = false;
+uint64_t TabuList::hash(const int *cell_vector) const {
+	uint64_t h = 0;
+	for(unsigned int i=0;i<n_machines;i++)
+		h ^= key(i, cell_vector[i]);
+	return h;
+}
 
-	int *comparison_vector = sol->cell_vector;
+bool TabuList::is_tabu(Solution *sol) {
+	return is_tabu(sol->cell_vector, hash(sol->cell_vector));
+}
+
+bool TabuList::is_tabu(const int *cell_vector, uint64_t hash) const {
 
-	std::list<Tabu_item>::iterator itr;
-	for ( itr = tabu_list.begin(); itr != tabu_list.end(); itr++)
-	{
-		int *solution_vector = itr->solution->cell_vector;
-		unsigned int i=0;
-		for(i=0;i<n_machines;i++){
-			if(solution_vector[i] != comparison_vector[i])
-				break;
-		}
+	if(size == 0)
+		return false;
 
-		if(i==n_machines){
-			tabu = true;
-			break;
-		}
+	for(int e = buckets[hash & bucket_mask]; e != -1; e = next[e]){
+		if(hashes[e] == hash &&
+				memcmp(&arena[e*n_machines], cell_vector, sizeof(int)*n_machines) == 0)
+			return true;
 	}
 
-	return tabu;
+	return false;
+}
+
+void TabuList::remove_oldest() {
+
+	int e = head;
+	int *link = &buckets[hashes[e] & bucket_mask];
+	while(*link != e)
+		link = &next[*link];
+	*link = next[e];
+
+	head = (head+1) % capacity;
+	size--;
 }
 
 void TabuList::update_tabu() {
-	std::list<Tabu_item>::iterator itr;
-	for ( itr = tabu_list.begin(); itr != tabu_list.end(); itr++ )
-	{
-		itr->turns--;
-		if(itr->turns == 0){
-			itr = tabu_list.erase(itr);
-		}
-	}
+	turn++;
+	while(size > 0 && expires[head] <= turn)
+		remove_oldest();
 }
 
 void TabuList::add_tabu(Solution* sol) {
 
-	Tabu_item *item = new Tabu_item();
-	item->solution = sol->clone();
-	item->turns = tabu_turns;
-	tabu_list.push_back(*item);
+	if(capacity == 0)
+		return;
+
+	if(size == capacity)
+		remove_oldest();
+
+	insert(sol->cell_vector, turn + tabu_turns);
+}
+
+void TabuList::insert(const int *cell_vector, unsigned int expires_at) {
+
+	int e = (head+size) % capacity;
+	uint64_t h = hash(cell_vector);
+
+	memcpy(&arena[e*n_machines], cell_vector, sizeof(int)*n_machines);
+	hashes[e] = h;
+	expires[e] = expires_at;
+	next[e] = buckets[h & bucket_mask];
+	buckets[h & bucket_mask] = e;
+	size++;
+}
+
+void TabuList::save(int *out) const {
+
+	// de la más antigua a la más nueva: expiración y cell_vector
+	for(unsigned int s=0;s<size;s++){
+		unsigned int e = (head+s) % capacity;
+		*out++ = expires[e];
+		memcpy(out, &arena[e*n_machines], sizeof(int)*n_machines);
+		out += n_machines;
+	}
 }
 
-tabu_item::~tabu_item(){
-	delete this->solution;
+bool TabuList::restore(unsigned int turn, unsigned int n_entries, const int *data) {
+
+	if(n_entries > capacity)
+		return false;
+
+	// las posiciones en el anillo pueden cambiar, el orden y el contenido no
+	std::fill(buckets.begin(), buckets.end(), -1);
+	this->head = 0;
+	this->size = 0;
+	this->turn = turn;
+	for(unsigned int s=0;s<n_entries;s++){
+		insert(data+1, data[0]);
+		data += 1+n_machines;
+	}
+
+	return true;
 }
 
 } /* namespace tabu */
@@ -9,31 +9,74 @@
 #define TABULIST_H_
 
 #include "Solution.h"
-#include <list>
+#include <vector>
+#include <stdint.h>
 
 namespace tabu {
 
-typedef struct tabu_item {
-
-public:
-	Solution *solution;
-	int turns;
-	~tabu_item();
-
-} Tabu_item;
-
+/*
+ * Lista tabú de capacidad fija: las soluciones se guardan en un anillo
+ * contiguo (arena) de tabu_turns+1 entradas, indexado por un hash Zobrist
+ * de 64 bits del cell_vector. Cada entrada expira tabu_turns llamadas a
+ * update_tabu después de agregada. tabu_turns <= 0 desactiva la lista.
+ * reset() la vacía para otra corrida reutilizando los arreglos.
+ */
 class TabuList {
 public:
 	TabuList(unsigned int n_machines, int tabu_turns);
 	virtual ~TabuList();
+	void reset(unsigned int n_machines, int tabu_turns);
 	bool is_tabu(Solution *sol);
+	bool is_tabu(const int *cell_vector, uint64_t hash) const;
 	void update_tabu();
 	void add_tabu(Solution *sol);
+	uint64_t hash(const int *cell_vector) const;
+	uint64_t swap_hash(uint64_t hash, const int *cell_vector,
+			unsigned int i, unsigned int j) const;
+	unsigned int entries() const;
+	unsigned int current_turn() const;
+	void save(int *out) const;
+	bool restore(unsigned int turn, unsigned int n_entries, const int *data);
 private:
-	std::list<Tabu_item> tabu_list;
+	uint64_t key(unsigned int machine, int cell) const;
+	void remove_oldest();
+	void insert(const int *cell_vector, unsigned int expires_at);
 	unsigned int n_machines;
 	int tabu_turns;
+	unsigned int capacity;
+	std::vector<int> arena;               // capacity * n_machines
+	std::vector<uint64_t> hashes;
+	std::vector<unsigned int> expires;    // turno de expiración
+	std::vector<int> next;                // siguiente entrada en el bucket
+	std::vector<int> buckets;
+	uint64_t bucket_mask;
+	unsigned int head;                    // entrada más antigua
+	unsigned int size;
+	unsigned int turn;
 };
 
+inline unsigned int TabuList::entries() const {
+	return size;
+}
+
+inline unsigned int TabuList::current_turn() const {
+	return turn;
+}
+
+// clave Zobrist de la máquina en la celda (splitmix64, sin tabla)
+inline uint64_t TabuList::key(unsigned int machine, int cell) const {
+	uint64_t z = ((uint64_t)machine << 32) + (uint32_t)cell + 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+inline uint64_t TabuList::swap_hash(uint64_t hash, const int *cell_vector,
+		unsigned int i, unsigned int j) const {
+	int cell_i = cell_vector[i];
+	int cell_j = cell_vector[j];
+	return hash ^ key(i, cell_i) ^ key(i, cell_j) ^ key(j, cell_j) ^ key(j, cell_i);
+}
+
 } /* namespace tabu */
 #endif /* TABULIST_H_ */
@@ -1,5 +1,6 @@
 
 #pragma OPENCL EXTENSION cl_khr_global_int32_base_atomics : enable
+#pragma OPENCL EXTENSION cl_khr_local_int32_base_atomics : enable
 
 typedef struct cl_params {
 
@@ -10,141 +11,160 @@ typedef struct cl_params {
 } ClParams;
 
 
-__kernel void local_search(
-		__constant ClParams *params,
-		__global int *solution,
-		__local int *lsol, // sizeof(int)*n_machines
-		__global int *gsol // sizeof(int)*n_machines*n_machines
-){
-	
-	int n_machines = params->n_machines;
-	
-	uint sol_offset = ((get_global_id(0)*n_machines)+get_global_id(1))*n_machines;
-	uint i = get_global_id(0);// n_machines
-	uint j = get_global_id(1);// n_machines
-	
-	int tmp = gsol[sol_offset+i];
-	gsol[sol_offset+i] = gsol[sol_offset+j];
-	gsol[sol_offset+j] = tmp;
-	
-}
-
+/*
+ * Costo exacto de cada solución candidata, igual a Solver::get_cost.
+ * Un work-group por candidata: get_group_id(0) = i*n_machines+j es la
+ * solución actual con las máquinas i y j intercambiadas, que se arma en
+ * memoria local (no hay buffer de candidatas). Cada work-item suma un
+ * subconjunto de partes y el costo se reduce en memoria local.
+ * La incidencia llega por partes en CSR (part_offsets, part_machines), así
+ * que cada candidata cuesta O(nnz) y no O(n_machines*n_parts).
+ * get_local_size(0) debe ser potencia de 2.
+ */
 __kernel void costs(
 		__global uint *cost_out,
 		__constant ClParams *params,
-		__constant int *incidence_matrix,
-		__global int *gsol,
-		__local int *parts_cells // n_machines*n_machines
+		__global const int *part_offsets,  // n_parts+1
+		__global const int *part_machines, // nnz, máquinas de cada parte
+		__global const int *solution, // solución actual, n_machines
+		__local int *cells,          // n_machines
+		__local uint *machines_cell, // n_cells
+		__local uint *partial        // local size
 ){
-	uint cost = 0;
-	
-	uint j = get_global_id(2);// sum j=1...P
-	uint i_sol = get_global_id(0);// sum i=1...M 0...(n_machines*n_machines*n_machines)-1
-	uint i_ = get_global_id(1); // sum i_=1...M
-
 	int n_machines = params->n_machines;
 	int n_parts = params->n_parts;
-	uint sol_offset = i_sol/n_machines;
-	
-	__global int *solution = gsol+sol_offset;
-
-	int i = i_sol%(n_machines);
-
-//	if(get_local_id(0)==0&&get_local_id(1)==0&&get_local_id(2)==0){
-//		parts_cells[0] = 0;
-//		parts_cells[1] = 0;
-//		parts_cells[2] = 0;
-//		parts_cells[3] = 0;
-//		parts_cells[4] = 0;
-//		parts_cells[5] = 0;
-//		parts_cells[6] = 0;
-//		parts_cells[7] = 0;
-//		parts_cells[8] = 0;
-//		parts_cells[9] = 0;
-//		parts_cells[10] = 0;
-//		parts_cells[11] = 0;
-//		parts_cells[12] = 0;
-//		parts_cells[13] = 0;
-//		parts_cells[14] = 0;
-//		parts_cells[15] = 0;
-//	}
-		
-	//barrier( CLK_LOCAL_MEM_FENCE );
-	
-	if(incidence_matrix[i*n_parts+j] == 1){
-	
-		if(solution[i] != solution[i_]){
-				
-			if(incidence_matrix[i_*n_parts+j] == 1){
-
-				if(parts_cells[i] != -1){
-					
-//						for(int il=0;il<16;il++){
-//							if(il!=i)atomic_xchg(parts_cells+il, -1);
-//								//parts_cells[il] = (il!=i)?-1:0;
-//						}
-
-						cost++;
-				}
-			}
-		}	
+	int n_cells = params->n_cells;
+	int max_machines_cell = params->max_machines_cell;
+
+	uint sol = get_group_id(0);
+	uint lid = get_local_id(0);
+	uint lsize = get_local_size(0);
+
+	// sólo pares i < j (el resto repite un swap o no mueve nada)
+	if(sol%n_machines <= sol/n_machines){
+		if(lid == 0)
+			cost_out[sol] = UINT_MAX;
+		return;
 	}
 
-	
-	//atom_add (cost_out+sol_offset,cost);
-	cost_out[sol_offset] += cost;
-}
+	for(int i=lid;i<n_machines;i+=lsize)
+		cells[i] = solution[i];
+	for(int k=lid;k<n_cells;k+=lsize)
+		machines_cell[k] = 0;
 
-__kernel void penalizaciones_Mmax(
-		__global uint *cost_out,
-		__constant ClParams *params,
-		__global int *gsol,
-		__local uint *machines_cell){
-	
-    uint sol_offset = get_global_id(1); // n_machines * n_machines
-    uint k = get_global_id(0); // cell
-    uint i = get_local_id(2); // local work group cell 0 ... n_machines
-    uint cost = 0;
-    
-	if(i == 0)
-		*machines_cell = 0;
-	
 	barrier( CLK_LOCAL_MEM_FENCE );
-	
-	int n_machines = params->n_machines;
-	int n_parts = params->n_parts;
-    int max_machines_cell = params->max_machines_cell;
-	
-    __global int *item = gsol+(sol_offset*n_machines)+i;
 
-    if(*item == (int)k)
-    	atomic_add(machines_cell,1);
-    
+	if(lid == 0){
+		// movimiento (i,j) de la candidata
+		int i = sol/n_machines;
+		int j = sol%n_machines;
+		int tmp = cells[i];
+		cells[i] = cells[j];
+		cells[j] = tmp;
+	}
+
+	barrier( CLK_LOCAL_MEM_FENCE );
+
+	for(int i=lid;i<n_machines;i+=lsize){
+		int k = cells[i];
+		if(k >= 0 && k < n_cells)
+			atomic_inc(machines_cell+k);
+	}
+
 	barrier( CLK_LOCAL_MEM_FENCE );
 
-		int _machines_cell = *machines_cell; // cached private?
-		
-		if(_machines_cell > max_machines_cell){
-			cost = ( (_machines_cell - max_machines_cell) * n_parts ); 
+	uint cost = 0;
 
-	    	atom_add (cost_out+sol_offset,cost);
+	// penalización y_ik <= Mmax
+	if(lid == 0){
+		for(int k=0;k<n_cells;k++){
+			int difference = (int)machines_cell[k] - max_machines_cell;
+			if(difference > 0)
+				cost += difference*n_machines*n_parts;
 		}
+	}
 
+	// parte j: la primera celda (menor índice) con una máquina de la parte
+	// se queda con ella, las máquinas fuera de esa celda son excepcionales
+	for(int j=lid;j<n_parts;j+=lsize){
+		int first = n_cells;
+		int begin = part_offsets[j];
+		int end = part_offsets[j+1];
+		uint machines_in = 0;
+
+		for(int p=begin;p<end;p++){
+			int k = cells[part_machines[p]];
+			if(k >= 0 && k < first){
+				first = k;
+				machines_in = 1;
+			}
+			else if(k == first)
+				machines_in++;
+		}
+
+		if(first < n_cells)
+			cost += (end-begin) - machines_in;
+	}
+
+	partial[lid] = cost;
+
+	barrier( CLK_LOCAL_MEM_FENCE );
+
+	for(uint s=lsize/2;s>0;s>>=1){
+		if(lid < s)
+			partial[lid] += partial[lid+s];
+		barrier( CLK_LOCAL_MEM_FENCE );
+	}
+
+	if(lid == 0)
+		cost_out[sol] = partial[0];
 }
 
+/*
+ * Mínimo de cost_out con un único work-group (potencia de 2); en empate
+ * gana el menor índice, como el recorrido secuencial.
+ */
 __kernel void mejor_solucion(
 		__global uint *cost_out,
-		__global int *gsol,
+		__constant ClParams *params,
 		__global uint *best_i,
-		__global uint *best_cost)
+		__global uint *best_cost,
+		__local uint *local_cost,
+		__local uint *local_i)
 {
+	uint lid = get_local_id(0);
+	uint lsize = get_local_size(0);
+	uint n = params->n_machines*params->n_machines;
+
+	uint cost = UINT_MAX;
+	uint index = 0;
+	for(uint i=lid;i<n;i+=lsize){
+		if(cost_out[i] < cost){
+			cost = cost_out[i];
+			index = i;
+		}
+	}
+
+	local_cost[lid] = cost;
+	local_i[lid] = index;
+
+	barrier( CLK_LOCAL_MEM_FENCE );
 
-	uint i = get_global_id(0); // n_machines * n_machines
+	for(uint s=lsize/2;s>0;s>>=1){
+		if(lid < s){
+			uint other_cost = local_cost[lid+s];
+			uint other_i = local_i[lid+s];
+			if(other_cost < local_cost[lid] ||
+					(other_cost == local_cost[lid] && other_i < local_i[lid])){
+				local_cost[lid] = other_cost;
+				local_i[lid] = other_i;
+			}
+		}
+		barrier( CLK_LOCAL_MEM_FENCE );
+	}
 
-	atomic_min(best_cost,cost_out[i]);
-	
-	barrier( CLK_GLOBAL_MEM_FENCE );
-	
-	if(*best_cost == cost_out[i])
-		atomic_xchg(best_i,i);
+	if(lid == 0){
+		*best_cost = local_cost[0];
+		*best_i = local_i[0];
+	}
 }
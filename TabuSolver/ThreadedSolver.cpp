@@ -0,0 +1,189 @@
+#include "ThreadedSolver.h"
+
+namespace tabu {
+
+static bool better_candidate(const SwapCandidate &a, const SwapCandidate &b) {
+	// desempate determinista por (i,j)
+	if(a.cost != b.cost)
+		return a.cost < b.cost;
+	if(a.i != b.i)
+		return a.i < b.i;
+	return a.j < b.j;
+}
+
+ThreadedSolver::ThreadedSolver(unsigned int max_iterations,
+		int diversification_param, unsigned int n_machines,
+		unsigned int n_parts, unsigned int n_cells,
+		unsigned int max_machines_cell, Matrix* incidence_matrix,
+		int tabu_turns, unsigned int n_threads) :
+		Solver(max_iterations, diversification_param, n_machines, n_parts,
+				n_cells, max_machines_cell, incidence_matrix, tabu_turns) {
+
+	if(n_threads == 0)
+		n_threads = std::thread::hardware_concurrency();
+	if(n_threads == 0)
+		n_threads = 1;
+
+	this->n_threads = n_threads;
+	this->pool = NULL;
+	this->scan_cost = 0;
+	this->scan_hash = 0;
+}
+
+ThreadedSolver::~ThreadedSolver() {
+	delete pool;
+}
+
+void ThreadedSolver::init() {
+
+	Solver::init();
+
+	// el pool y las copias por worker se conservan entre corridas
+	if(pool == NULL){
+		pool = new WorkerPool(n_threads);
+		scan_task = std::bind(&ThreadedSolver::scan, this, std::placeholders::_1);
+	}
+	worker_cells.resize(n_threads);
+	for(unsigned int w=0;w<n_threads;w++)
+		worker_cells[w].assign(n_machines, 0);
+	worker_best.resize(n_threads);
+	worker_min.resize(n_threads);
+	worker_rand.assign(n_threads, 0);
+	worker_evaluated.assign(n_threads, 0);
+#ifdef TABU_PROFILE
+	worker_lookups.assign(n_threads, 0);
+#endif
+}
+
+void ThreadedSolver::scan(unsigned int worker) {
+
+	SwapCandidate best = { LONG_MAX, 0, 0 };
+	SwapCandidate min = { LONG_MAX, 0, 0 };
+	long best_cost = -1; // mínimo de la fila del último aceptado, como en la serial
+	unsigned long evaluated = 0;
+	unsigned int rand_local = worker_rand[worker];
+#ifdef TABU_PROFILE
+	unsigned long lookups = 0; // local: los contadores por worker comparten línea
+#endif
+
+	int *cells = &worker_cells[worker][0];
+	std::copy(current_solution->cell_vector,
+			current_solution->cell_vector+n_machines, cells);
+	const unsigned int *next = &next_candidate[0];
+
+	// filas intercaladas para repartir la carga triangular
+	for(unsigned int i=worker;i<n_machines;i+=n_threads){
+		long row_cost = -1;
+		bool all_j = next[i] == i;
+		for(unsigned int j = all_j ? i+1 : next[i+1]; j<n_machines;
+				j = all_j ? j+1 : next[j+1]){
+
+			evaluated++;
+
+			// como Solution::exchange: la máquina 0 no se mueve
+			bool moved = i > 0 && cells[i] != cells[j];
+			long cost = scan_cost;
+			uint64_t hash = scan_hash;
+			if(moved){
+				hash = tabu_list->swap_hash(scan_hash, cells, i, j);
+				cost += delta_evaluator->swap_delta(i,j);
+			}
+
+			if(row_cost < 0 || cost < row_cost)
+				row_cost = cost;
+
+			SwapCandidate candidate = { cost, i, j };
+			if(better_candidate(candidate, min))
+				min = candidate;
+
+			bool accept = best_cost < 0;
+			if(!accept && cost < best_cost){
+				if(moved)
+					std::swap(cells[i], cells[j]);
+				PROFILE_ADD(lookups, 1);
+				accept = !tabu_list->is_tabu(cells, hash) &&
+						rand_r(&rand_local)%100 < 90;
+				if(moved)
+					std::swap(cells[i], cells[j]);
+			}
+
+			if(accept){
+				best = candidate;
+				best_cost = row_cost;
+			}
+		}
+	}
+
+	worker_best[worker] = best;
+	worker_min[worker] = min;
+	worker_rand[worker] = rand_local;
+	worker_evaluated[worker] = evaluated;
+#ifdef TABU_PROFILE
+	worker_lookups[worker] = lookups;
+#endif
+}
+
+int ThreadedSolver::local_search(){
+
+	double start = wall_time();
+
+	scan_cost = delta_evaluator->load(current_solution);
+	scan_hash = tabu_list->hash(current_solution->cell_vector);
+
+	// misma lista de candidatos que Solver::local_search_with
+	bool restricted = candidate_list_period > 0 &&
+			n_iterations % candidate_list_period != 0;
+	unsigned int *next = &next_candidate[0];
+	next[n_machines] = n_machines;
+	for(int x=n_machines-1;x>=0;x--)
+		next[x] = (!restricted || delta_evaluator->candidate(x)) ? x : next[x+1];
+
+	// el worker 0 sigue la secuencia del Solver, los demás parten de ella
+	for(unsigned int w=1;w<n_threads;w++)
+		worker_rand[w] = next_random();
+	worker_rand[0] = rand_state;
+
+	pool->run(scan_task);
+
+	rand_state = worker_rand[0];
+
+	SwapCandidate best = worker_best[0];
+	SwapCandidate min = worker_min[0];
+	unsigned long evaluated = worker_evaluated[0];
+#ifdef TABU_PROFILE
+	for(unsigned int w=0;w<n_threads;w++){
+		profile.counters[PROFILE_TABU_LOOKUPS] += worker_lookups[w];
+		worker_lookups[w] = 0;
+	}
+#endif
+	for(unsigned int w=1;w<n_threads;w++){
+		if(better_candidate(worker_best[w], best))
+			best = worker_best[w];
+		if(better_candidate(worker_min[w], min))
+			min = worker_min[w];
+		evaluated += worker_evaluated[w];
+	}
+
+	if(min.cost < global_best_cost){
+		builder->destroy_solution(global_best);
+		global_best = builder->copy_solution(current_solution);
+		global_best->exchange(min.i, min.j);
+		global_best->cost = min.cost;
+		global_best_cost = min.cost;
+	}
+
+	// sin pares evaluados (lista de candidatos vacía) no hay movimiento
+	if(best.cost != LONG_MAX){
+		current_solution->exchange(best.i, best.j);
+		current_solution->cost = best.cost;
+	}
+
+	tabu_list->add_tabu(current_solution);
+
+	n_evaluations += evaluated;
+	iter_cost_time += (wall_time() - start)*1e9;
+
+	return 0;
+}
+
+} /* namespace tabu */
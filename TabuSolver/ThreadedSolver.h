@@ -0,0 +1,55 @@
+#ifndef THREADEDSOLVER_H_
+#define THREADEDSOLVER_H_
+
+#include "Solver.h"
+#include "WorkerPool.h"
+
+namespace tabu {
+
+// mejor movimiento (i,j) encontrado por un worker
+typedef struct swap_candidate {
+
+	long cost;
+	unsigned int i;
+	unsigned int j;
+} SwapCandidate;
+
+/*
+ * Búsqueda local multihilo en CPU: los pares (i,j) del vecindario de
+ * Solver::local_search (mismo recorrido, misma lista de candidatos) se
+ * reparten por filas entre los workers de un WorkerPool persistente. Cada
+ * worker evalúa con el DeltaEvaluator compartido (sólo lectura) sobre su
+ * propia copia de la solución y aplica la regla de aceptación serial a sus
+ * filas, con su propio generador; los movimientos aceptados por cada worker
+ * se combinan por (costo, i, j). El worker 0 usa el generador del Solver,
+ * así que con -T 1 la búsqueda es la misma que la serial.
+ */
+class ThreadedSolver: public tabu::Solver {
+public:
+	ThreadedSolver(unsigned int max_iterations, int diversification_param,
+			unsigned int n_machines, unsigned int n_parts, unsigned int n_cells,
+			unsigned int max_machines_cell, Matrix *incidence_matrix,
+			int tabu_turns, unsigned int n_threads);
+	virtual ~ThreadedSolver();
+
+protected:
+	void init();
+	int local_search();
+
+private:
+	void scan(unsigned int worker);
+	unsigned int n_threads;
+	WorkerPool *pool;
+	std::function<void(unsigned int)> scan_task;
+	std::vector<std::vector<int> > worker_cells;    // copia por worker
+	std::vector<SwapCandidate> worker_best;         // aceptado por la regla serial
+	std::vector<SwapCandidate> worker_min;          // mejor absoluto
+	std::vector<unsigned int> worker_rand;          // generador de cada worker
+	std::vector<unsigned long> worker_evaluated;    // pares evaluados
+	std::vector<unsigned long> worker_lookups;      // búsquedas tabú (TABU_PROFILE)
+	long scan_cost;
+	uint64_t scan_hash;
+};
+
+} /* namespace tabu */
+#endif /* THREADEDSOLVER_H_ */
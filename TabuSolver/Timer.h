@@ -0,0 +1,16 @@
+#ifndef TIMER_H_
+#define TIMER_H_
+
+#include <time.h>
+
+namespace tabu {
+
+// tiempo de pared monótono en segundos
+inline double wall_time() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+} /* namespace tabu */
+#endif /* TIMER_H_ */
@@ -0,0 +1,158 @@
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+
+namespace tabu {
+
+TraceSink::TraceSink(int level, unsigned int n_machines, FILE *out,
+		FILE *series, unsigned int capacity) :
+		head(0), tail(0), closing(false) {
+
+	this->level = level;
+	this->n_machines = n_machines;
+	this->out = out;
+	this->series = series;
+
+	this->capacity = 1;
+	while(this->capacity < capacity)
+		this->capacity <<= 1;
+
+	// sin nada que escribir no hay hilo ni ring (enabled() es siempre falso)
+	if(level == TRACE_NONE && series == NULL)
+		return;
+
+	ring.resize(this->capacity);
+	if(level >= TRACE_SOLUTIONS)
+		ring_cells.resize(this->capacity*n_machines);
+
+	consumer = std::thread(&TraceSink::consumer_loop, this);
+}
+
+TraceSink::~TraceSink() {
+	close();
+}
+
+void TraceSink::close() {
+	if(!consumer.joinable())
+		return;
+	closing.store(true, std::memory_order_release);
+	consumer.join();
+}
+
+TraceRecord *TraceSink::reserve(int **cells) {
+
+	unsigned long h = head.load(std::memory_order_relaxed);
+
+	// ring lleno: se espera al hilo de fondo
+	while(h - tail.load(std::memory_order_acquire) >= capacity)
+		std::this_thread::yield();
+
+	unsigned int slot = h & (capacity-1);
+	*cells = ring_cells.empty() ? NULL : &ring_cells[slot*n_machines];
+	return &ring[slot];
+}
+
+void TraceSink::publish() {
+	head.store(head.load(std::memory_order_relaxed)+1, std::memory_order_release);
+}
+
+void TraceSink::solution(int type, unsigned int iteration, long cost,
+		long global_best, const int *cells) {
+
+	if(!enabled(type))
+		return;
+
+	int *slot_cells;
+	TraceRecord *record = reserve(&slot_cells);
+	record->type = type;
+	record->iteration = iteration;
+	record->cost = cost;
+	record->global_best = global_best;
+	if(slot_cells != NULL)
+		std::copy(cells, cells+n_machines, slot_cells);
+	publish();
+}
+
+void TraceSink::summary(double cost_ms, double cpu_ms, const char *stop_reason,
+		unsigned int iterations) {
+
+	if(!enabled(TRACE_SUMMARY_TIMES))
+		return;
+
+	int *slot_cells;
+	TraceRecord *record = reserve(&slot_cells);
+	record->type = TRACE_SUMMARY_TIMES;
+	record->values[0] = cost_ms;
+	record->values[1] = cpu_ms;
+	record->label = stop_reason;
+	record->iteration = iterations;
+	publish();
+}
+
+void TraceSink::consumer_loop() {
+
+	while(true){
+		bool done = closing.load(std::memory_order_acquire);
+		unsigned long t = tail.load(std::memory_order_relaxed);
+		unsigned long h = head.load(std::memory_order_acquire);
+
+		if(t == h){
+			if(done)
+				break;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+
+		for(;t!=h;t++){
+			unsigned int slot = t & (capacity-1);
+			write(ring[slot], ring_cells.empty() ? NULL : &ring_cells[slot*n_machines]);
+			tail.store(t+1, std::memory_order_release);
+		}
+	}
+
+	if(out != NULL)
+		fflush(out);
+	if(series != NULL)
+		fflush(series);
+}
+
+void TraceSink::write_cells(const int *cells) {
+	for(unsigned int j=0;j<n_machines;j++)
+		fprintf(out, "%d ", cells[j]);
+}
+
+void TraceSink::write(const TraceRecord &r, const int *cells) {
+
+	if(r.type == TRACE_LOCAL && series != NULL)
+		fprintf(series, "%u %ld %ld\n", r.iteration, r.cost, r.global_best);
+
+	if(out == NULL)
+		return;
+
+	if(r.type == TRACE_SUMMARY_TIMES){
+		fprintf(out, "\nTotal cost evaluation time in milliseconds = %0.3f ms\n", r.values[0]);
+		fprintf(out, "Total CPU time in milliseconds = %0.3f ms\n", r.values[1]);
+		fprintf(out, "Stopped by %s after %u iterations\n", r.label, r.iteration);
+		return;
+	}
+
+	if(level < TRACE_COSTS)
+		return;
+
+	if(level < TRACE_SOLUTIONS){
+		const char *phase = r.type == TRACE_INITIAL ? "initial       " :
+				r.type == TRACE_LOCAL ? "local search  " : "global search ";
+		fprintf(out, "iteration %u  %scost: %ld  global best: %ld\n",
+				r.iteration, phase, r.cost, r.global_best);
+		return;
+	}
+
+	if(r.type == TRACE_LOCAL)
+		fprintf(out, "----- iteration %u ------\nlocal search  ", r.iteration);
+	else if(r.type == TRACE_GLOBAL)
+		fputs("global search ", out);
+	write_cells(cells);
+	fprintf(out, "  cost: %ld  global best: %ld\n", r.cost, r.global_best);
+}
+
+} /* namespace tabu */
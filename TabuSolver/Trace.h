@@ -0,0 +1,84 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <cstdio>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+namespace tabu {
+
+// niveles de verbosidad (-v)
+enum TraceLevel {
+	TRACE_NONE = 0,      // nada
+	TRACE_SUMMARY = 1,   // sólo el resumen final
+	TRACE_COSTS = 2,     // costos de cada iteración
+	TRACE_SOLUTIONS = 3  // además la solución completa
+};
+
+enum TraceEvent {
+	TRACE_INITIAL,
+	TRACE_LOCAL,   // después de local_search
+	TRACE_GLOBAL,  // después de global_search
+	TRACE_SUMMARY_TIMES
+};
+
+typedef struct trace_record {
+
+	int type;
+	unsigned int iteration;
+	long cost;
+	long global_best;
+	double values[2];
+	const char *label;
+} TraceRecord;
+
+/*
+ * Traza asíncrona de un Solver. El solver (único productor) deja eventos
+ * en un ring buffer sin locks y un hilo de fondo los formatea y escribe en
+ * out según el nivel, y la serie "iteración costo mejor" de cada búsqueda
+ * local en series (para gnuplot) si no es NULL. Los costos los entrega el
+ * solver, nunca se recalculan aquí. Si el ring está lleno el productor
+ * espera, no se pierden eventos. close() (o el destructor) vacía el ring y
+ * termina el hilo.
+ */
+class TraceSink {
+public:
+	TraceSink(int level, unsigned int n_machines, FILE *out, FILE *series,
+			unsigned int capacity = 1024);
+	virtual ~TraceSink();
+	bool enabled(int type) const;
+	void solution(int type, unsigned int iteration, long cost,
+			long global_best, const int *cells);
+	void summary(double cost_ms, double cpu_ms, const char *stop_reason,
+			unsigned int iterations);
+	void close();
+private:
+	TraceRecord *reserve(int **cells);
+	void publish();
+	void consumer_loop();
+	void write(const TraceRecord &record, const int *cells);
+	void write_cells(const int *cells);
+	int level;
+	unsigned int n_machines;
+	unsigned int capacity; // potencia de 2
+	FILE *out;
+	FILE *series;
+	std::vector<TraceRecord> ring;
+	std::vector<int> ring_cells; // capacity * n_machines si level == TRACE_SOLUTIONS
+	std::atomic<unsigned long> head; // siguiente a escribir (productor)
+	std::atomic<unsigned long> tail; // siguiente a leer (hilo de fondo)
+	std::atomic<bool> closing;
+	std::thread consumer;
+};
+
+inline bool TraceSink::enabled(int type) const {
+	if(type == TRACE_SUMMARY_TIMES)
+		return level >= TRACE_SUMMARY;
+	if(type == TRACE_LOCAL && series != NULL)
+		return true;
+	return level >= TRACE_COSTS;
+}
+
+} /* namespace tabu */
+#endif /* TRACE_H_ */
@@ -0,0 +1,75 @@
+#include "WorkerPool.h"
+
+namespace tabu {
+
+WorkerPool::WorkerPool(unsigned int n_workers) {
+	this->task = NULL;
+	this->generation = 0;
+	this->pending = 0;
+	this->stop = false;
+
+	if(n_workers == 0)
+		n_workers = 1;
+
+	for(unsigned int w=1;w<n_workers;w++)
+		threads.push_back(std::thread(&WorkerPool::worker_loop, this, w));
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	start_cond.notify_all();
+	for(unsigned int t=0;t<threads.size();t++)
+		threads[t].join();
+}
+
+unsigned int WorkerPool::size() const {
+	return threads.size()+1;
+}
+
+void WorkerPool::run(const std::function<void(unsigned int)> &task) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->task = &task;
+		pending = threads.size();
+		generation++;
+	}
+	start_cond.notify_all();
+
+	task(0);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while(pending > 0)
+		done_cond.wait(lock);
+	this->task = NULL;
+}
+
+void WorkerPool::worker_loop(unsigned int worker) {
+
+	unsigned long seen = 0;
+
+	while(true){
+		const std::function<void(unsigned int)> *current;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			while(!stop && generation == seen)
+				start_cond.wait(lock);
+			if(stop)
+				return;
+			seen = generation;
+			current = task;
+		}
+
+		(*current)(worker);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			pending--;
+		}
+		done_cond.notify_one();
+	}
+}
+
+} /* namespace tabu */
@@ -0,0 +1,35 @@
+#ifndef WORKERPOOL_H_
+#define WORKERPOOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace tabu {
+
+/*
+ * Pool persistente de hilos. run() ejecuta la tarea en todos los workers
+ * (el hilo que llama es el worker 0) y retorna cuando todos terminan.
+ */
+class WorkerPool {
+public:
+	WorkerPool(unsigned int n_workers);
+	virtual ~WorkerPool();
+	void run(const std::function<void(unsigned int)> &task);
+	unsigned int size() const;
+private:
+	void worker_loop(unsigned int worker);
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable start_cond;
+	std::condition_variable done_cond;
+	const std::function<void(unsigned int)> *task;
+	unsigned long generation;
+	unsigned int pending;
+	bool stop;
+};
+
+} /* namespace tabu */
+#endif /* WORKERPOOL_H_ */
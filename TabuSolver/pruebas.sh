@@ -1,9 +1,12 @@
 #!/bin/sh
 
+# cada instancia se lee una vez; las corridas mapean la versión binaria
+./TabuConvert problema_*.txt || exit 1
+
 for i in $(seq --format="%02g" 01 10)
 do
 	for j in $(seq --format="%02g" 01 30)
 	do
-		./TabuSolver -i 5000 -d 2 -c 2 -m 8 -t 100 -f "problema_${i}.txt" -O "out/${i}_${j}.txt"
+		./TabuSolver -v 1 -i 5000 -d 2 -c 2 -m 8 -t 100 -f "problema_${i}.bin" -O "out/${i}_${j}.txt"
 	done
 done